@@ -82,6 +82,11 @@
 	#endif
 #endif
 
+// Enables thread-local scratch arena, which is rewound after each job. See ion::FrameArenaResource.
+#ifndef ION_CONFIG_SCRATCH_ARENA
+	#define ION_CONFIG_SCRATCH_ARENA ION_CONFIG_JOB_SCHEDULER
+#endif
+
 // Enables global memory pool
 #ifndef ION_CONFIG_GLOBAL_MEMORY_POOL
 	#ifndef __SANITIZE_ADDRESS__
@@ -91,6 +96,12 @@
 	#endif
 #endif
 
+// Enables NUMA aware placement of global memory pool blocks. Thread-local pools allocate their blocks from the memory node of the
+// thread's processor. Has no effect on single node systems.
+#ifndef ION_CONFIG_NUMA
+	#define ION_CONFIG_NUMA (ION_PLATFORM_LINUX || ION_PLATFORM_MICROSOFT)
+#endif
+
 // Enables Job Scheduler
 #ifndef ION_CONFIG_JOB_SCHEDULER
 	#define ION_CONFIG_JOB_SCHEDULER 1
@@ -157,6 +168,8 @@
 	#define ION_EXTERNAL_STRING_CONVERSIONS 1
 #endif
 
+// Unordered map and set implementation: 0 - std::unordered_map, 1 - https://github.com/Tessil/hopscotch-map (map only),
+// 2 - ion::SwissMap and ion::SwissSet
 #ifndef ION_EXTERNAL_UNORDERED_MAP
 	#define ION_EXTERNAL_UNORDERED_MAP 0
 #endif
@@ -193,6 +206,21 @@
 	#define ION_MEMORY_TRACKER ION_CONFIG_ERROR_CHECKING
 #endif
 
+// Enables sampling heap profiler. Only call stacks of sampled allocations are recorded, thus profiler is cheap enough to be
+// enabled also in release builds.
+#ifndef ION_HEAP_PROFILER
+	#define ION_HEAP_PROFILER 0
+#endif
+
+// Enables per memory tag accounting of global memory pool. Accounting only updates thread local counters and stores memory tag
+// to existing block header.
+#ifndef ION_MEMORY_ACCOUNTING
+	#define ION_MEMORY_ACCOUNTING ION_CONFIG_GLOBAL_MEMORY_POOL
+#endif
+
+// Memory tags are stored per thread and per job when memory tracking, heap profiling or memory accounting is enabled
+#define ION_MEMORY_TAGS (ION_MEMORY_TRACKER || ION_HEAP_PROFILER || ION_MEMORY_ACCOUNTING)
+
 // Clean exit expects program to be correctly destructed before exit.
 // Otherwise program will assume it can exit early without full destruction.
 #ifndef ION_CLEAN_EXIT
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <type_traits>
 #include <ion/Base.h>
 #if ION_PLATFORM_MICROSOFT
 	#include <cstdarg>
@@ -80,6 +81,16 @@ struct IsConst<const type> : IntegralConstant<bool, true>
 {
 };
 
+// Type can be moved to another address by copying its bytes, without calling move constructor and destructor. This applies to
+// all types that do not hold pointers to themselves. Defaults to trivially copyable types, specialize for other types.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T>
+{
+};
+
+template <typename T>
+constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
 }  // namespace ion
 
 // Forward declarations for common types
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <ion/Types.h>
 #include <ion/memory/Memory.h>
 #include <ion/memory/Ptr.h>
 
@@ -200,5 +201,11 @@ bool operator!=(const ion::ArenaAllocator<T1, Source1>& a, const ion::ArenaAlloc
 	return a.GetSource() != b.GetSource();
 }
 
+// Allocator refers to source only by pointer
+template <typename T, typename Source>
+struct IsTriviallyRelocatable<ArenaAllocator<T, Source>> : std::true_type
+{
+};
+
 }  // namespace ion
 
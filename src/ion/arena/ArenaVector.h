@@ -730,9 +730,9 @@ private:
 	template <typename Buffer>
 	inline void MoveStatic(Value* dst, Buffer&& src, size_t count)
 	{
-		if (std::is_trivially_copyable<Value>::value)
+		if constexpr (IsTriviallyRelocatableV<Value>)
 		{
-			std::memcpy(dst, &src[0], count * sizeof(Value));
+			ion::Relocate(dst, &src[0], count);
 		}
 		else
 		{
@@ -1035,4 +1035,11 @@ private:
 template <typename Value, size_t BufferSize = (2 * sizeof(ion::RawBuffer<Value>) - (sizeof(uint8_t) * 2)) / sizeof(Value)>
 using TinyArenaVector = ArenaVector<Value, 0, uint8_t, BufferSize>;
 
+// Small buffer is referred by data pointer, thus only vectors without small buffer can be relocated.
+template <typename Value, uint32_t SmallItemCount, typename CountType, uint32_t TinyItemCount>
+struct IsTriviallyRelocatable<ArenaVector<Value, SmallItemCount, CountType, TinyItemCount>>
+  : std::bool_constant<SmallItemCount == 0 && (TinyItemCount == 0 || IsTriviallyRelocatableV<Value>)>
+{
+};
+
 }  // namespace ion
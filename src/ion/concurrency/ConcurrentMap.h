@@ -0,0 +1,231 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/concurrency/AutoLock.h>
+#include <ion/concurrency/Mutex.h>
+
+#include <ion/container/UnorderedMap.h>
+
+#include <ion/debug/AccessGuard.h>
+
+#include <ion/util/Math.h>
+
+#include <utility>
+
+namespace ion
+{
+// Hash map for data that is read by many threads and written rarely.
+//
+// Keys are distributed to 'NumShards' independent maps, each protected with its own shared mutex. Readers of the same shard
+// do not block each other and writers block only readers and writers of the same shard. Values are never exposed outside
+// the lock, lookups either copy the value or give it to a callback that is run while shard is read locked.
+template <typename TKey, typename TValue, typename THasher = Hasher<TKey>,
+		  typename Allocator = GlobalAllocator<Pair<TKey const, TValue>>, size_t NumShards = 16>
+class ConcurrentMap
+{
+	static_assert(ion::IsPowerOfTwo(NumShards), "Number of shards must be power of two");
+	using Map = UnorderedMap<TKey, TValue, THasher, Allocator>;
+
+	struct ION_ALIGN_CACHE_LINE Shard
+	{
+		Shard(size_t expectedSize) : mMap(expectedSize) {}
+
+		template <typename Resource>
+		Shard(Resource* resource, size_t expectedSize) : mMap(resource, expectedSize)
+		{
+		}
+
+		SharedMutex mMutex;
+		Map mMap;
+		ION_ACCESS_GUARD(mGuard);
+	};
+
+public:
+	using KeyType = TKey;
+	using ValueType = TValue;
+
+	ION_CLASS_NON_COPYABLE_NOR_MOVABLE(ConcurrentMap);
+
+	ConcurrentMap(size_t expectedSize = 32 * NumShards)
+	  : ConcurrentMap(std::make_index_sequence<NumShards>(), ion::Max(expectedSize / NumShards, size_t(1)))
+	{
+	}
+
+	template <typename Resource>
+	ConcurrentMap(Resource* resource, size_t expectedSize = 32 * NumShards)
+	  : ConcurrentMap(std::make_index_sequence<NumShards>(), resource, ion::Max(expectedSize / NumShards, size_t(1)))
+	{
+	}
+
+	// Copies value to 'out' if key is found
+	bool Find(const TKey& key, TValue& out) const
+	{
+		return Find(key, [&](const TValue& value) { out = value; });
+	}
+
+	// Calls callback(const TValue&) if key is found. Shard is read locked during the call, callback must not modify this map.
+	template <typename Callback>
+	bool Find(const TKey& key, Callback&& callback) const
+	{
+		const Shard& shard = ShardOf(key);
+		AutoReadLock<SharedMutex> lock(shard.mMutex);
+		ION_ACCESS_GUARD_READ_BLOCK(shard.mGuard);
+		const TValue* value = shard.mMap.Lookup(key);
+		if (value)
+		{
+			callback(*value);
+			return true;
+		}
+		return false;
+	}
+
+	bool Contains(const TKey& key) const
+	{
+		return Find(key, [](const TValue&) {});
+	}
+
+	// Returns true if key was inserted, false if existing value was replaced
+	template <typename Value>
+	bool InsertOrAssign(const TKey& key, Value&& value)
+	{
+		Shard& shard = ShardOf(key);
+		AutoLock<SharedMutex> lock(shard.mMutex);
+		ION_ACCESS_GUARD_WRITE_BLOCK(shard.mGuard);
+		TValue* existing = shard.mMap.Lookup(key);
+		if (existing)
+		{
+			*existing = std::forward<Value>(value);
+			return false;
+		}
+		shard.mMap.Insert(key, TValue(std::forward<Value>(value)));
+		return true;
+	}
+
+	// Inserts value only if key is not found. Returns true if value was inserted.
+	template <typename Value>
+	bool TryInsert(const TKey& key, Value&& value)
+	{
+		Shard& shard = ShardOf(key);
+		AutoLock<SharedMutex> lock(shard.mMutex);
+		ION_ACCESS_GUARD_WRITE_BLOCK(shard.mGuard);
+		if (shard.mMap.Lookup(key))
+		{
+			return false;
+		}
+		shard.mMap.Insert(key, TValue(std::forward<Value>(value)));
+		return true;
+	}
+
+	// Calls callback(TValue&) if key is found. Shard is write locked during the call.
+	template <typename Callback>
+	bool Update(const TKey& key, Callback&& callback)
+	{
+		Shard& shard = ShardOf(key);
+		AutoLock<SharedMutex> lock(shard.mMutex);
+		ION_ACCESS_GUARD_WRITE_BLOCK(shard.mGuard);
+		TValue* value = shard.mMap.Lookup(key);
+		if (value)
+		{
+			callback(*value);
+			return true;
+		}
+		return false;
+	}
+
+	// Returns true if key was found and erased
+	bool Erase(const TKey& key)
+	{
+		Shard& shard = ShardOf(key);
+		AutoLock<SharedMutex> lock(shard.mMutex);
+		ION_ACCESS_GUARD_WRITE_BLOCK(shard.mGuard);
+		auto iter = shard.mMap.Find(key);
+		if (iter != shard.mMap.End())
+		{
+			shard.mMap.Erase(iter);
+			return true;
+		}
+		return false;
+	}
+
+	// Calls callback(const TKey&, const TValue&) for all elements. Each shard is read locked while its elements are visited,
+	// thus elements of a shard are a consistent snapshot, but other shards can be modified during iteration. Callback must
+	// not modify this map.
+	template <typename Callback>
+	void ForEach(Callback&& callback) const
+	{
+		for (const Shard& shard : mShards)
+		{
+			AutoReadLock<SharedMutex> lock(shard.mMutex);
+			ION_ACCESS_GUARD_READ_BLOCK(shard.mGuard);
+			for (auto iter = shard.mMap.Begin(); iter != shard.mMap.End(); ++iter)
+			{
+				callback(iter->first, iter->second);
+			}
+		}
+	}
+
+	void Clear()
+	{
+		for (Shard& shard : mShards)
+		{
+			AutoLock<SharedMutex> lock(shard.mMutex);
+			ION_ACCESS_GUARD_WRITE_BLOCK(shard.mGuard);
+			shard.mMap.Clear();
+		}
+	}
+
+	// Number of elements. Result is not exact if map is modified during the call.
+	size_t Size() const
+	{
+		size_t size = 0;
+		for (const Shard& shard : mShards)
+		{
+			AutoReadLock<SharedMutex> lock(shard.mMutex);
+			size += shard.mMap.Size();
+		}
+		return size;
+	}
+
+	bool IsEmpty() const { return Size() == 0; }
+
+private:
+	template <size_t... Index>
+	ConcurrentMap(std::index_sequence<Index...>, size_t shardSize) : mShards{((void)Index, Shard(shardSize))...}
+	{
+	}
+
+	template <size_t... Index, typename Resource>
+	ConcurrentMap(std::index_sequence<Index...>, Resource* resource, size_t shardSize)
+	  : mShards{((void)Index, Shard(resource, shardSize))...}
+	{
+	}
+
+	size_t ShardIndex(const TKey& key) const
+	{
+		// Use high bits of the hash. Low bits are used for finding buckets inside shard.
+		uint64_t h = uint64_t(mHasher(key)) * 0x9E3779B97F4A7C15ull;
+		return size_t(h >> 32) & (NumShards - 1);
+	}
+
+	Shard& ShardOf(const TKey& key) { return mShards[ShardIndex(key)]; }
+
+	const Shard& ShardOf(const TKey& key) const { return mShards[ShardIndex(key)]; }
+
+	Shard mShards[NumShards];
+	THasher mHasher;
+};
+}  // namespace ion
@@ -70,6 +70,12 @@ public:
 
 	~SharedMutex();
 
+	ION_PLATFORM_INLINING void Lock() const;
+
+	ION_PLATFORM_INLINING bool TryLock() const;
+
+	ION_PLATFORM_INLINING void Unlock() const;
+
 	ION_PLATFORM_INLINING void LockReadOnly() const;
 
 	ION_PLATFORM_INLINING bool TryLockReadOnly() const;
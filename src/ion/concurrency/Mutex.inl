@@ -83,6 +83,46 @@ ION_PLATFORM_INLINING void Mutex::Unlock() const
 #endif
 }
 
+ION_PLATFORM_INLINING bool SharedMutex::TryLock() const
+{
+#if ION_PLATFORM_MICROSOFT
+	return TryAcquireSRWLockExclusive(mMutex.Ptr<SharedMutexType>());
+#else
+	int res = pthread_rwlock_trywrlock(&mMutex.Ref<SharedMutexType>().mutex);
+	ION_ASSERT(res == EBUSY || res == 0, "pthread_rwlock_trywrlock - failed");
+	return res == 0;
+#endif
+}
+
+ION_PLATFORM_INLINING void SharedMutex::Lock() const
+{
+#if ION_MUTEX_CONTENTION_CHECKER
+	ion::RunningTimerUs contentionTimer;
+	static bool contentionDetected = false;
+#endif
+
+#if ION_PLATFORM_MICROSOFT
+	AcquireSRWLockExclusive(mMutex.Ptr<SharedMutexType>());
+#else
+	int res = pthread_rwlock_wrlock(&mMutex.Ref<SharedMutexType>().mutex);
+	ION_ASSERT(res == 0, "pthread_rwlock_wrlock - failed");
+#endif
+
+#if ION_MUTEX_CONTENTION_CHECKER
+	CheckContention(contentionTimer, contentionDetected);
+#endif
+}
+
+ION_PLATFORM_INLINING void SharedMutex::Unlock() const
+{
+#if ION_PLATFORM_MICROSOFT
+	ReleaseSRWLockExclusive(mMutex.Ptr<SharedMutexType>());
+#else
+	int res = pthread_rwlock_unlock(&mMutex.Ref<SharedMutexType>().mutex);
+	ION_ASSERT(res == 0, "pthread_rwlock_unlock - failed");
+#endif
+}
+
 ION_PLATFORM_INLINING bool SharedMutex::TryLockReadOnly() const
 {
 #if ION_PLATFORM_MICROSOFT
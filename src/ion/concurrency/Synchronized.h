@@ -38,14 +38,23 @@ public:
 		callback(mInternalData);
 	}
 
-	// Concurrent read access, will block if already accessed
-	// #TODO: Don't block other read accesses
+	// Concurrent read access, will block if already write-accessed. Other read accesses are blocked only if mutex does not
+	// support shared locking.
 	template <typename Callback>
 	inline void Access(Callback&& callback) const
 	{
-		ion::AutoLock<const MutexType> lock(mMutex);
-		ION_ACCESS_GUARD_READ_BLOCK(mGuard);
-		callback(mInternalData);
+		if constexpr (requires { mMutex.LockReadOnly(); })
+		{
+			ion::AutoReadLock<const MutexType> lock(mMutex);
+			ION_ACCESS_GUARD_READ_BLOCK(mGuard);
+			callback(mInternalData);
+		}
+		else
+		{
+			ion::AutoLock<const MutexType> lock(mMutex);
+			ION_ACCESS_GUARD_READ_BLOCK(mGuard);
+			callback(mInternalData);
+		}
 	}
 
 	template <typename Callback>
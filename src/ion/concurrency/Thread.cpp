@@ -15,6 +15,7 @@
  */
 #include <ion/debug/Profiling.h>
 
+#include <ion/memory/FrameArenaResource.h>
 #include <ion/memory/GlobalMemoryPool.h>
 #include <ion/memory/UniquePtr.h>
 
@@ -64,6 +65,9 @@ extern ION_THREAD_LOCAL BaseJob* ion::Thread::mJob = nullptr;
 #if ION_CONFIG_TEMPORARY_ALLOCATOR
 extern ION_THREAD_LOCAL ion::temporary::BytePool* ion::Thread::mTemporaryMemory = nullptr;
 #endif
+#if ION_CONFIG_SCRATCH_ARENA
+extern ION_THREAD_LOCAL ion::FrameArenaResource* ion::Thread::mScratchArena = nullptr;
+#endif
 #if ION_CONFIG_JOB_SCHEDULER
 extern ION_THREAD_LOCAL uint64_t ion::Thread::mRandState[2] = {0};
 #endif
@@ -77,7 +81,7 @@ extern ION_THREAD_LOCAL ion::Thread::QueueIndex ion::Thread::mQueueIndex = 0;
 #if ION_PROFILER_BUFFER_SIZE_PER_THREAD > 0
 extern ION_THREAD_LOCAL ProfilingBuffer* ion::Thread::mProfiling = nullptr;
 #endif
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 extern ION_THREAD_LOCAL ion::MemTag ion::Thread::mMemoryTag = ion::tag::Unset;
 #endif
 #if 0
@@ -255,6 +259,14 @@ void ion::Thread::Deinit()
 #if ION_PROFILER_BUFFER_SIZE_PER_THREAD > 0
 	mProfiling = nullptr;
 #endif
+#if ION_CONFIG_SCRATCH_ARENA
+	if (mScratchArena)
+	{
+		ION_MEMORY_SCOPE(ion::tag::Temporary);
+		delete mScratchArena;
+		mScratchArena = nullptr;
+	}
+#endif
 #if ION_CONFIG_JOB_SCHEDULER || ION_CONFIG_GLOBAL_MEMORY_POOL
 	gThreadIdPool.load()->Free(mId);
 #endif
@@ -424,6 +436,15 @@ ion::temporary::BytePool& ion::Thread::InitTemporaryMemory()
 }
 #endif
 
+#if ION_CONFIG_SCRATCH_ARENA
+ion::FrameArenaResource& ion::Thread::InitScratchArena()
+{
+	ION_MEMORY_SCOPE(ion::tag::Temporary);
+	mScratchArena = new ion::FrameArenaResource();
+	return *mScratchArena;
+}
+#endif
+
 unsigned int ion::Thread::GetFPControlWord() { return FPControl::GetControlWord(); }
 
 // http://stackoverflow.com/questions/13397571/precise-thread-sleep-needed-max-1ms-error
@@ -35,6 +35,7 @@ namespace ion
 class BaseJob;
 class ProfilingBuffer;
 class ThreadSynchronizer;
+class FrameArenaResource;
 namespace temporary
 {
 struct BytePool;
@@ -66,6 +67,9 @@ extern ION_THREAD_LOCAL BaseJob* mJob;
 #if ION_CONFIG_TEMPORARY_ALLOCATOR
 extern ION_THREAD_LOCAL ion::temporary::BytePool* mTemporaryMemory;
 #endif
+#if ION_CONFIG_SCRATCH_ARENA
+extern ION_THREAD_LOCAL FrameArenaResource* mScratchArena;
+#endif
 #if ION_CONFIG_JOB_SCHEDULER
 extern ION_THREAD_LOCAL uint64_t mRandState[2];
 #endif
@@ -79,7 +83,7 @@ extern ION_THREAD_LOCAL QueueIndex mQueueIndex;
 #if ION_PROFILER_BUFFER_SIZE_PER_THREAD > 0
 extern ION_THREAD_LOCAL ProfilingBuffer* mProfiling;
 #endif
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 extern ION_THREAD_LOCAL ion::MemTag mMemoryTag;
 #endif
 
@@ -103,7 +107,7 @@ inline BaseJob* GetCurrentJob()
 	return nullptr;
 #endif
 }
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 inline ion::MemTag& MemoryTag() { return Thread::mMemoryTag; }
 #endif
 
@@ -124,6 +128,13 @@ ion::temporary::BytePool& InitTemporaryMemory();
 inline ion::temporary::BytePool& GetTemporaryPool() { return mTemporaryMemory ? *mTemporaryMemory : InitTemporaryMemory(); }
 #endif
 
+#if ION_CONFIG_SCRATCH_ARENA
+FrameArenaResource& InitScratchArena();
+
+// Thread local arena for job temporaries. Allocations are released when current job finishes.
+inline FrameArenaResource& GetScratchArena() { return mScratchArena ? *mScratchArena : InitScratchArena(); }
+#endif
+
 bool IsReady();
 
 bool IsThreadInitialized();
@@ -15,8 +15,11 @@
  */
 #pragma once
 #include <ion/Base.h>
+#include <ion/Types.h>
 #include <ion/tracing/Log.h>
 #include <algorithm>
+#include <cstring>
+#include <new>
 
 namespace ion
 {
@@ -44,6 +47,63 @@ inline void MoveBackward(InputIt first, InputIt last, OutputIt d_first)
 	std::move_backward(first, last, d_first);
 }
 
+// Moves objects to uninitialized memory and destroys source objects. Ranges must not overlap.
+template <typename Value>
+inline void Relocate(Value* ION_RESTRICT destination, Value* ION_RESTRICT source, size_t count)
+{
+	if constexpr (IsTriviallyRelocatableV<Value>)
+	{
+		if (count > 0)
+		{
+			std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(Value));
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			new (static_cast<void*>(&destination[i])) Value(std::move(source[i]));
+			source[i].~Value();
+		}
+	}
+}
+
+namespace detail
+{
+// Rotates relocatable objects using a stack buffer for the objects that are rotated over
+constexpr size_t RelocateRotateBufferSize = 256;
+
+template <typename Value>
+constexpr bool CanRelocateRotate(size_t offset)
+{
+	return !std::is_trivially_copyable<Value>::value && IsTriviallyRelocatableV<Value> &&
+		   offset * sizeof(Value) <= RelocateRotateBufferSize;
+}
+
+// Moves [offset, offset + count) to [0, count) and [0, offset) to [count, count + offset)
+template <typename Value>
+inline void RelocateRotateLeft(Value* buffer, size_t offset, size_t count)
+{
+	alignas(Value) uint8_t tmp[RelocateRotateBufferSize];
+	std::memcpy(tmp, static_cast<const void*>(buffer), offset * sizeof(Value));
+	std::memmove(static_cast<void*>(buffer), static_cast<const void*>(buffer + offset), count * sizeof(Value));
+	std::memcpy(static_cast<void*>(buffer + count), tmp, offset * sizeof(Value));
+}
+
+// Moves [0, count) to [offset, offset + count) and [count, count + offset) to [0, offset)
+template <typename Value>
+inline void RelocateRotateRight(Value* buffer, size_t offset, size_t count)
+{
+	alignas(Value) uint8_t tmp[RelocateRotateBufferSize];
+	std::memcpy(tmp, static_cast<const void*>(buffer + count), offset * sizeof(Value));
+	std::memmove(static_cast<void*>(buffer + offset), static_cast<const void*>(buffer), count * sizeof(Value));
+	std::memcpy(static_cast<void*>(buffer), tmp, offset * sizeof(Value));
+}
+}  // namespace detail
+
+// Moves 'count' objects from 'buffer + offset' to 'buffer'. Objects in [buffer + count, buffer + offset + count) are left
+// in valid, but unspecified state. Trivially relocatable objects are rotated, thus objects that were overwritten are found
+// from the end of the range.
 template <typename Value>
 inline void MoveBackByOffset(Value* buffer, size_t offset, size_t count)
 {
@@ -51,12 +111,19 @@ inline void MoveBackByOffset(Value* buffer, size_t offset, size_t count)
 	{
 		ion::Copy(buffer + offset, buffer + offset + count, buffer);
 	}
+	else if (detail::CanRelocateRotate<Value>(offset))
+	{
+		detail::RelocateRotateLeft(buffer, offset, count);
+	}
 	else
 	{
 		ion::Move(buffer + offset, buffer + offset + count, buffer);
 	}
 }
 
+// Moves 'count' objects ending at 'buffer - offset' to end at 'buffer'. Objects in the beginning of the range are left in
+// valid, but unspecified state. Trivially relocatable objects are rotated, thus objects that were overwritten are found
+// from the beginning of the range.
 template <typename Value>
 inline void MoveForwardByOffset(Value* buffer, size_t offset, size_t count)
 {
@@ -67,6 +134,10 @@ inline void MoveForwardByOffset(Value* buffer, size_t offset, size_t count)
 	{
 		ion::CopyBackward(first, last, buffer);
 	}
+	else if (detail::CanRelocateRotate<Value>(offset))
+	{
+		detail::RelocateRotateRight(first, offset, count);
+	}
 	else
 	{
 		ion::MoveBackward(first, last, buffer);
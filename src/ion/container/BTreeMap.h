@@ -0,0 +1,1053 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/container/Algorithm.h>
+#include <ion/container/FlatSearch.h>
+#include <ion/container/StaticRawBuffer.h>
+#include <ion/container/Vector.h>
+
+#include <ion/memory/GlobalAllocator.h>
+
+#include <ion/util/Math.h>
+
+#include <cstring>	   // std::memmove
+#include <functional>  // std::less
+#include <iterator>
+#include <memory>  // std::allocator_traits
+#include <utility>
+
+namespace ion
+{
+namespace detail
+{
+struct BTreeNoValue
+{
+};
+
+// Moves elements [pos, count) one slot right. Slot at pos is left uninitialized.
+template <typename T>
+inline void BTreeOpenGap(T* data, size_t pos, size_t count)
+{
+	if constexpr (IsTriviallyRelocatableV<T>)
+	{
+		std::memmove(static_cast<void*>(data + pos + 1), static_cast<const void*>(data + pos), (count - pos) * sizeof(T));
+	}
+	else
+	{
+		for (size_t i = count; i > pos; --i)
+		{
+			new (static_cast<void*>(data + i)) T(std::move(data[i - 1]));
+			data[i - 1].~T();
+		}
+	}
+}
+
+// Moves elements (pos, count) one slot left to fill uninitialized slot at pos
+template <typename T>
+inline void BTreeCloseGap(T* data, size_t pos, size_t count)
+{
+	if constexpr (IsTriviallyRelocatableV<T>)
+	{
+		std::memmove(static_cast<void*>(data + pos), static_cast<const void*>(data + pos + 1), (count - pos - 1) * sizeof(T));
+	}
+	else
+	{
+		for (size_t i = pos; i + 1 < count; ++i)
+		{
+			new (static_cast<void*>(data + i)) T(std::move(data[i + 1]));
+			data[i + 1].~T();
+		}
+	}
+}
+
+// B+tree storing entries in leaves that are linked in key order. Inner nodes have only separator keys and child pointers.
+// Keys of child i are less than separator i and keys of child i + 1 are not less than separator i.
+template <typename TKey, typename TValue, typename Compare, typename TAllocator, size_t NodeSize>
+class BTree
+{
+protected:
+	static constexpr bool HasValues = !std::is_same_v<TValue, BTreeNoValue>;
+	static constexpr size_t LeafEntrySize = sizeof(TKey) + (HasValues ? sizeof(TValue) : 0);
+	static_assert(NodeSize >= 64, "Too small nodes");
+
+public:
+	static constexpr size_t LeafCapacity = ion::Max(size_t(4), (NodeSize - 3 * sizeof(void*)) / LeafEntrySize);
+	static constexpr size_t InnerCapacity = ion::Max(size_t(4), (NodeSize - 2 * sizeof(void*)) / (sizeof(TKey) + sizeof(void*)));
+	static_assert(LeafCapacity <= UINT16_MAX && InnerCapacity <= UINT16_MAX, "Too large nodes");
+
+protected:
+	static constexpr uint32_t LeafMin = LeafCapacity / 2;
+	static constexpr uint32_t InnerMin = InnerCapacity / 2;
+
+	// Inner nodes have at least 3 children, which limits tree height well below this
+	static constexpr uint32_t MaxDepth = 48;
+
+	struct Node
+	{
+		uint32_t mCount;  // Number of entries in leaf, number of keys in inner node
+		bool mIsLeaf;
+	};
+
+	using ValueStorage = std::conditional_t<HasValues, AlignedStorage<TValue, LeafCapacity>, BTreeNoValue>;
+
+	struct Leaf : Node
+	{
+		Leaf* mPrev;
+		Leaf* mNext;
+		AlignedStorage<TKey, LeafCapacity> mKeys;
+		ValueStorage mValues;
+	};
+
+	struct Inner : Node
+	{
+		AlignedStorage<TKey, InnerCapacity> mKeys;
+		Node* mChildren[InnerCapacity + 1];
+	};
+
+	static constexpr size_t NodeAlignment =
+	  ion::Max(size_t(ION_CONFIG_CACHE_LINE_SIZE), ion::Max(alignof(Leaf), alignof(Inner)));
+
+	// Inner nodes visited from root to leaf and child index taken at each of them
+	struct Path
+	{
+		Inner* mNodes[MaxDepth];
+		uint32_t mIndices[MaxDepth];
+		uint32_t mDepth;
+	};
+
+	using NodeAllocator = typename std::allocator_traits<TAllocator>::template rebind_alloc<uint8_t>;
+
+public:
+	template <bool IsConst>
+	class IteratorBase
+	{
+		friend class BTree;
+		using LeafType = std::conditional_t<IsConst, const Leaf, Leaf>;
+		using ValueRef = std::conditional_t<IsConst, const TValue&, TValue&>;
+
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = std::conditional_t<HasValues, std::pair<const TKey, TValue>, TKey>;
+		using difference_type = ptrdiff_t;
+
+		IteratorBase() {}
+
+		const TKey& Key() const { return mLeaf->mKeys[mIndex]; }
+
+		ValueRef Value() const
+		{
+			static_assert(HasValues, "No values");
+			return mLeaf->mValues[mIndex];
+		}
+
+		// Key and value pair for maps, key for sets
+		decltype(auto) operator*() const
+		{
+			if constexpr (HasValues)
+			{
+				return std::pair<const TKey&, ValueRef>(Key(), Value());
+			}
+			else
+			{
+				return Key();
+			}
+		}
+
+		IteratorBase& operator++()
+		{
+			if (++mIndex == mLeaf->mCount && mLeaf->mNext)
+			{
+				mLeaf = mLeaf->mNext;
+				mIndex = 0;
+			}
+			return *this;
+		}
+
+		IteratorBase operator++(int)
+		{
+			IteratorBase result(*this);
+			++(*this);
+			return result;
+		}
+
+		IteratorBase& operator--()
+		{
+			if (mIndex == 0)
+			{
+				mLeaf = mLeaf->mPrev;
+				mIndex = mLeaf->mCount;
+			}
+			--mIndex;
+			return *this;
+		}
+
+		IteratorBase operator--(int)
+		{
+			IteratorBase result(*this);
+			--(*this);
+			return result;
+		}
+
+		bool operator==(const IteratorBase& other) const { return mLeaf == other.mLeaf && mIndex == other.mIndex; }
+		bool operator!=(const IteratorBase& other) const { return !(*this == other); }
+
+	private:
+		IteratorBase(LeafType* leaf, uint32_t index) : mLeaf(leaf), mIndex(index) {}
+
+		LeafType* mLeaf = nullptr;
+		uint32_t mIndex = 0;
+	};
+
+	using Iterator = IteratorBase<false>;
+	using ConstIterator = IteratorBase<true>;
+
+	BTree() {}
+
+	template <typename Resource>
+	BTree(Resource* resource) : mAllocator(resource)
+	{
+	}
+
+	BTree(const BTree& other) : mLess(other.mLess), mAllocator(other.mAllocator) { CopyFrom(other); }
+
+	BTree(BTree&& other) noexcept : mLess(std::move(other.mLess)), mAllocator(std::move(other.mAllocator)) { Steal(other); }
+
+	BTree& operator=(const BTree& other)
+	{
+		if (this != &other)
+		{
+			CopyFrom(other);
+		}
+		return *this;
+	}
+
+	BTree& operator=(BTree&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Clear();
+			mAllocator = std::move(other.mAllocator);
+			mLess = std::move(other.mLess);
+			Steal(other);
+		}
+		return *this;
+	}
+
+	~BTree() { Clear(); }
+
+	[[nodiscard]] size_t Size() const { return mSize; }
+
+	[[nodiscard]] bool IsEmpty() const { return mSize == 0; }
+
+	void Clear()
+	{
+		if (mRoot)
+		{
+			FreeSubtree(mRoot);
+		}
+		mRoot = nullptr;
+		mFirst = nullptr;
+		mLast = nullptr;
+		mSize = 0;
+	}
+
+	[[nodiscard]] Iterator Begin() { return mFirst ? Iterator(mFirst, 0) : Iterator(); }
+	[[nodiscard]] Iterator End() { return mLast ? Iterator(mLast, mLast->mCount) : Iterator(); }
+	[[nodiscard]] ConstIterator Begin() const { return mFirst ? ConstIterator(mFirst, 0) : ConstIterator(); }
+	[[nodiscard]] ConstIterator End() const { return mLast ? ConstIterator(mLast, mLast->mCount) : ConstIterator(); }
+	[[nodiscard]] Iterator begin() { return Begin(); }
+	[[nodiscard]] Iterator end() { return End(); }
+	[[nodiscard]] ConstIterator begin() const { return Begin(); }
+	[[nodiscard]] ConstIterator end() const { return End(); }
+
+	// First element not less than key
+	[[nodiscard]] Iterator LowerBound(const TKey& key)
+	{
+		auto [leaf, index] = LowerBoundPosition(key);
+		return leaf ? Iterator(leaf, index) : End();
+	}
+
+	[[nodiscard]] ConstIterator LowerBound(const TKey& key) const
+	{
+		auto [leaf, index] = LowerBoundPosition(key);
+		return leaf ? ConstIterator(leaf, index) : End();
+	}
+
+	// First element greater than key
+	[[nodiscard]] Iterator UpperBound(const TKey& key)
+	{
+		Iterator iter = LowerBound(key);
+		return (iter != End() && !mLess(key, iter.Key())) ? ++iter : iter;
+	}
+
+	[[nodiscard]] ConstIterator UpperBound(const TKey& key) const
+	{
+		ConstIterator iter = LowerBound(key);
+		return (iter != End() && !mLess(key, iter.Key())) ? ++iter : iter;
+	}
+
+	[[nodiscard]] Iterator Find(const TKey& key)
+	{
+		Iterator iter = LowerBound(key);
+		return (iter != End() && !mLess(key, iter.Key())) ? iter : End();
+	}
+
+	[[nodiscard]] ConstIterator Find(const TKey& key) const
+	{
+		ConstIterator iter = LowerBound(key);
+		return (iter != End() && !mLess(key, iter.Key())) ? iter : End();
+	}
+
+	[[nodiscard]] bool Contains(const TKey& key) const { return Find(key) != End(); }
+
+	// Returns true if key was found and removed
+	bool Remove(const TKey& key)
+	{
+		if (mRoot == nullptr)
+		{
+			return false;
+		}
+		Path path;
+		Leaf* leaf = Descend(key, &path);
+		const uint32_t pos = LeafLowerBound(leaf, key);
+		if (pos == leaf->mCount || mLess(key, leaf->mKeys[pos]))
+		{
+			return false;
+		}
+		EraseFromLeaf(leaf, pos);
+		mSize--;
+		if (path.mDepth == 0)
+		{
+			if (leaf->mCount == 0)
+			{
+				DeleteNode(leaf);
+				mRoot = nullptr;
+				mFirst = nullptr;
+				mLast = nullptr;
+			}
+		}
+		else if (leaf->mCount < LeafMin)
+		{
+			RebalanceLeaf(path, leaf);
+		}
+		return true;
+	}
+
+	// Calls callback for each element in key order. Callback gets (const TKey&, TValue&) for maps and (const TKey&) for sets.
+	template <typename Callback>
+	void ForEach(Callback&& callback)
+	{
+		ForEachLeafEntry(*this, mFirst, 0, [](auto*) { return true; }, callback);
+	}
+
+	template <typename Callback>
+	void ForEach(Callback&& callback) const
+	{
+		ForEachLeafEntry(*this, mFirst, 0, [](auto*) { return true; }, callback);
+	}
+
+	// Calls callback for each element in range [first, last) in key order
+	template <typename Callback>
+	void ForEachInRange(const TKey& first, const TKey& last, Callback&& callback)
+	{
+		ForEachInRangeImpl(*this, first, last, callback);
+	}
+
+	template <typename Callback>
+	void ForEachInRange(const TKey& first, const TKey& last, Callback&& callback) const
+	{
+		ForEachInRangeImpl(*this, first, last, callback);
+	}
+
+protected:
+	// Inserts entry constructed from arguments if key is not found. Returns iterator to the entry and true if inserted.
+	template <typename... Args>
+	std::pair<Iterator, bool> TryEmplace(const TKey& key, Args&&... args)
+	{
+		if (mRoot == nullptr)
+		{
+			Leaf* leaf = NewLeaf();
+			mRoot = leaf;
+			mFirst = leaf;
+			mLast = leaf;
+		}
+		Path path;
+		Leaf* leaf = Descend(key, &path);
+		uint32_t pos = LeafLowerBound(leaf, key);
+		if (pos < leaf->mCount && !mLess(key, leaf->mKeys[pos]))
+		{
+			return {Iterator(leaf, pos), false};
+		}
+
+		if (leaf->mCount == LeafCapacity)
+		{
+			Leaf* right = SplitLeaf(leaf);
+			Leaf* left = leaf;
+			if (pos > left->mCount)
+			{
+				pos -= left->mCount;
+				leaf = right;
+			}
+			InsertIntoLeaf(leaf, pos, key, std::forward<Args>(args)...);
+			InsertIntoParent(path, path.mDepth, left, right->mKeys[0], right);
+		}
+		else
+		{
+			InsertIntoLeaf(leaf, pos, key, std::forward<Args>(args)...);
+		}
+		mSize++;
+		return {Iterator(leaf, pos), true};
+	}
+
+	// Replaces contents with 'count' entries. Callback emplace(TKey*, TValue*) constructs next entry to given uninitialized
+	// memory and entries must be produced in ascending key order. Leaves are filled evenly and inner levels are built bottom-up.
+	template <typename Emplace>
+	void BuildFrom(size_t count, Emplace&& emplace)
+	{
+		Clear();
+		if (count == 0)
+		{
+			return;
+		}
+
+		ion::Vector<Node*> level;
+		ion::Vector<const TKey*> minKeys;
+		const size_t numLeaves = (count + LeafCapacity - 1) / LeafCapacity;
+		level.Reserve(numLeaves);
+		minKeys.Reserve(numLeaves);
+		const TKey* previousKey = nullptr;
+		for (size_t i = 0; i < numLeaves; ++i)
+		{
+			const uint32_t numEntries = uint32_t(count / numLeaves + (i < count % numLeaves ? 1 : 0));
+			Leaf* leaf = NewLeaf();
+			for (uint32_t j = 0; j < numEntries; ++j)
+			{
+				if constexpr (HasValues)
+				{
+					emplace(&leaf->mKeys[j], &leaf->mValues[j]);
+				}
+				else
+				{
+					emplace(&leaf->mKeys[j], static_cast<TValue*>(nullptr));
+				}
+				ION_ASSERT(previousKey == nullptr || mLess(*previousKey, leaf->mKeys[j]), "Keys must be sorted and unique");
+				previousKey = &leaf->mKeys[j];
+			}
+			leaf->mCount = numEntries;
+			if (mLast)
+			{
+				mLast->mNext = leaf;
+				leaf->mPrev = mLast;
+			}
+			else
+			{
+				mFirst = leaf;
+			}
+			mLast = leaf;
+			level.Add(leaf);
+			minKeys.Add(&leaf->mKeys[0]);
+		}
+		mSize = count;
+
+		while (level.Size() > 1)
+		{
+			const size_t numChildren = level.Size();
+			const size_t numParents = (numChildren + InnerCapacity) / (InnerCapacity + 1);
+			size_t child = 0;
+			for (size_t i = 0; i < numParents; ++i)
+			{
+				const size_t n = numChildren / numParents + (i < numChildren % numParents ? 1 : 0);
+				Inner* inner = NewInner();
+				inner->mChildren[0] = level[child];
+				const TKey* minKey = minKeys[child];
+				for (size_t j = 1; j < n; ++j)
+				{
+					inner->mKeys.Insert(j - 1, *minKeys[child + j]);
+					inner->mChildren[j] = level[child + j];
+				}
+				inner->mCount = uint32_t(n - 1);
+				// Parents are written over already processed children
+				level[i] = inner;
+				minKeys[i] = minKey;
+				child += n;
+			}
+			level.Resize(numParents);
+			minKeys.Resize(numParents);
+		}
+		mRoot = level[0];
+	}
+
+	uint32_t LeafLowerBound(const Leaf* leaf, const TKey& key) const
+	{
+		return uint32_t(ion::FlatLowerBound(leaf->mKeys.Data(), leaf->mCount, key, mLess));
+	}
+
+	Compare mLess;
+
+private:
+	uint32_t ChildIndex(const Inner* inner, const TKey& key) const
+	{
+		const uint32_t index = uint32_t(ion::FlatLowerBound(inner->mKeys.Data(), inner->mCount, key, mLess));
+		return (index < inner->mCount && !mLess(key, inner->mKeys[index])) ? index + 1 : index;
+	}
+
+	Leaf* Descend(const TKey& key, Path* path) const
+	{
+		Node* node = mRoot;
+		uint32_t depth = 0;
+		while (!node->mIsLeaf)
+		{
+			Inner* inner = static_cast<Inner*>(node);
+			const uint32_t child = ChildIndex(inner, key);
+			if (path)
+			{
+				ION_ASSERT(depth < MaxDepth, "Tree too deep");
+				path->mNodes[depth] = inner;
+				path->mIndices[depth] = child;
+			}
+			depth++;
+			node = inner->mChildren[child];
+		}
+		if (path)
+		{
+			path->mDepth = depth;
+		}
+		return static_cast<Leaf*>(node);
+	}
+
+	std::pair<Leaf*, uint32_t> LowerBoundPosition(const TKey& key) const
+	{
+		if (mRoot == nullptr)
+		{
+			return {nullptr, 0};
+		}
+		Leaf* leaf = Descend(key, nullptr);
+		const uint32_t pos = LeafLowerBound(leaf, key);
+		if (pos == leaf->mCount && leaf->mNext)
+		{
+			return {leaf->mNext, 0};
+		}
+		return {leaf, pos};
+	}
+
+	template <typename Self, typename Callback>
+	static void ForEachInRangeImpl(Self& self, const TKey& first, const TKey& last, Callback& callback)
+	{
+		if (self.mRoot == nullptr || !self.mLess(first, last))
+		{
+			return;
+		}
+		Leaf* leaf = self.Descend(first, nullptr);
+		ForEachLeafEntry(self, leaf, self.LeafLowerBound(leaf, first),
+						 [&](Leaf* current)
+						 {
+							 // Whole leaf is in range unless its last key is not less than end of range
+							 return self.mLess(current->mKeys[current->mCount - 1], last);
+						 },
+						 callback, &last);
+	}
+
+	// Iterates entries from given position until a leaf that is not fully in range
+	template <typename Self, typename IsLeafInRange, typename Callback>
+	static void ForEachLeafEntry(Self& self, Leaf* leaf, uint32_t pos, IsLeafInRange&& isLeafInRange, Callback& callback,
+								 const TKey* last = nullptr)
+	{
+		for (; leaf; leaf = leaf->mNext, pos = 0)
+		{
+			const bool isInRange = isLeafInRange(leaf);
+			const uint32_t end = isInRange ? leaf->mCount : self.LeafLowerBound(leaf, *last);
+			for (; pos < end; ++pos)
+			{
+				if constexpr (HasValues)
+				{
+					if constexpr (std::is_const_v<Self>)
+					{
+						callback(static_cast<const TKey&>(leaf->mKeys[pos]), static_cast<const TValue&>(leaf->mValues[pos]));
+					}
+					else
+					{
+						callback(static_cast<const TKey&>(leaf->mKeys[pos]), leaf->mValues[pos]);
+					}
+				}
+				else
+				{
+					callback(static_cast<const TKey&>(leaf->mKeys[pos]));
+				}
+			}
+			if (!isInRange)
+			{
+				return;
+			}
+		}
+	}
+
+	template <typename... Args>
+	void InsertIntoLeaf(Leaf* leaf, uint32_t pos, const TKey& key, Args&&... args)
+	{
+		detail::BTreeOpenGap(leaf->mKeys.Data(), pos, leaf->mCount);
+		leaf->mKeys.Insert(pos, key);
+		if constexpr (HasValues)
+		{
+			detail::BTreeOpenGap(leaf->mValues.Data(), pos, leaf->mCount);
+			leaf->mValues.Insert(pos, std::forward<Args>(args)...);
+		}
+		leaf->mCount++;
+	}
+
+	void EraseFromLeaf(Leaf* leaf, uint32_t pos)
+	{
+		leaf->mKeys.Erase(pos);
+		detail::BTreeCloseGap(leaf->mKeys.Data(), pos, leaf->mCount);
+		if constexpr (HasValues)
+		{
+			leaf->mValues.Erase(pos);
+			detail::BTreeCloseGap(leaf->mValues.Data(), pos, leaf->mCount);
+		}
+		leaf->mCount--;
+	}
+
+	static void RelocateEntries(Leaf* target, uint32_t targetPos, Leaf* source, uint32_t sourcePos, uint32_t count)
+	{
+		ion::Relocate(target->mKeys.Data() + targetPos, source->mKeys.Data() + sourcePos, count);
+		if constexpr (HasValues)
+		{
+			ion::Relocate(target->mValues.Data() + targetPos, source->mValues.Data() + sourcePos, count);
+		}
+	}
+
+	// Moves upper half of full leaf to a new leaf that is linked after it
+	Leaf* SplitLeaf(Leaf* leaf)
+	{
+		Leaf* right = NewLeaf();
+		const uint32_t mid = LeafCapacity / 2;
+		RelocateEntries(right, 0, leaf, mid, leaf->mCount - mid);
+		right->mCount = leaf->mCount - mid;
+		leaf->mCount = mid;
+		right->mPrev = leaf;
+		right->mNext = leaf->mNext;
+		if (leaf->mNext)
+		{
+			leaf->mNext->mPrev = right;
+		}
+		else
+		{
+			mLast = right;
+		}
+		leaf->mNext = right;
+		return right;
+	}
+
+	// Adds separator and new right node after 'left' to parent at given depth. Full parents are split up to the root.
+	void InsertIntoParent(Path& path, uint32_t depth, Node* left, TKey separator, Node* right)
+	{
+		while (depth > 0)
+		{
+			Inner* parent = path.mNodes[depth - 1];
+			const uint32_t index = path.mIndices[depth - 1];
+			if (parent->mCount < InnerCapacity)
+			{
+				detail::BTreeOpenGap(parent->mKeys.Data(), index, parent->mCount);
+				parent->mKeys.Insert(index, std::move(separator));
+				std::memmove(parent->mChildren + index + 2, parent->mChildren + index + 1, (parent->mCount - index) * sizeof(Node*));
+				parent->mChildren[index + 1] = right;
+				parent->mCount++;
+				return;
+			}
+
+			// Gather keys and children with the new entry and divide them between parent and new sibling
+			AlignedStorage<TKey, InnerCapacity + 1> keys;
+			Node* children[InnerCapacity + 2];
+			ion::Relocate(keys.Data(), parent->mKeys.Data(), index);
+			keys.Insert(index, std::move(separator));
+			ion::Relocate(keys.Data() + index + 1, parent->mKeys.Data() + index, InnerCapacity - index);
+			std::memcpy(children, parent->mChildren, (index + 1) * sizeof(Node*));
+			children[index + 1] = right;
+			std::memcpy(children + index + 2, parent->mChildren + index + 1, (InnerCapacity - index) * sizeof(Node*));
+
+			constexpr uint32_t Total = InnerCapacity + 1;
+			constexpr uint32_t Mid = Total / 2;
+			Inner* sibling = NewInner();
+			ion::Relocate(parent->mKeys.Data(), keys.Data(), Mid);
+			std::memcpy(parent->mChildren, children, (Mid + 1) * sizeof(Node*));
+			parent->mCount = Mid;
+			ion::Relocate(sibling->mKeys.Data(), keys.Data() + Mid + 1, Total - Mid - 1);
+			std::memcpy(sibling->mChildren, children + Mid + 1, (Total - Mid) * sizeof(Node*));
+			sibling->mCount = Total - Mid - 1;
+
+			separator = std::move(keys[Mid]);
+			keys.Erase(Mid);
+			left = parent;
+			right = sibling;
+			depth--;
+		}
+
+		Inner* root = NewInner();
+		root->mKeys.Insert(0, std::move(separator));
+		root->mChildren[0] = left;
+		root->mChildren[1] = right;
+		root->mCount = 1;
+		mRoot = root;
+	}
+
+	// Removes key at given index and child after it
+	static void RemoveFromInner(Inner* node, uint32_t keyIndex)
+	{
+		node->mKeys.Erase(keyIndex);
+		detail::BTreeCloseGap(node->mKeys.Data(), keyIndex, node->mCount);
+		std::memmove(node->mChildren + keyIndex + 1, node->mChildren + keyIndex + 2, (node->mCount - keyIndex - 1) * sizeof(Node*));
+		node->mCount--;
+	}
+
+	void RebalanceLeaf(Path& path, Leaf* leaf)
+	{
+		const uint32_t depth = path.mDepth;
+		Inner* parent = path.mNodes[depth - 1];
+		const uint32_t index = path.mIndices[depth - 1];
+		Leaf* left = index > 0 ? static_cast<Leaf*>(parent->mChildren[index - 1]) : nullptr;
+		Leaf* right = index < parent->mCount ? static_cast<Leaf*>(parent->mChildren[index + 1]) : nullptr;
+		if (left && left->mCount > LeafMin)
+		{
+			detail::BTreeOpenGap(leaf->mKeys.Data(), 0, leaf->mCount);
+			if constexpr (HasValues)
+			{
+				detail::BTreeOpenGap(leaf->mValues.Data(), 0, leaf->mCount);
+			}
+			RelocateEntries(leaf, 0, left, left->mCount - 1, 1);
+			left->mCount--;
+			leaf->mCount++;
+			parent->mKeys[index - 1] = leaf->mKeys[0];
+		}
+		else if (right && right->mCount > LeafMin)
+		{
+			RelocateEntries(leaf, leaf->mCount, right, 0, 1);
+			detail::BTreeCloseGap(right->mKeys.Data(), 0, right->mCount);
+			if constexpr (HasValues)
+			{
+				detail::BTreeCloseGap(right->mValues.Data(), 0, right->mCount);
+			}
+			right->mCount--;
+			leaf->mCount++;
+			parent->mKeys[index] = right->mKeys[0];
+		}
+		else if (left)
+		{
+			MergeLeaves(left, leaf);
+			RemoveFromInner(parent, index - 1);
+			RebalanceInner(path, depth - 1);
+		}
+		else
+		{
+			MergeLeaves(leaf, right);
+			RemoveFromInner(parent, index);
+			RebalanceInner(path, depth - 1);
+		}
+	}
+
+	void MergeLeaves(Leaf* left, Leaf* right)
+	{
+		RelocateEntries(left, left->mCount, right, 0, right->mCount);
+		left->mCount += right->mCount;
+		left->mNext = right->mNext;
+		if (right->mNext)
+		{
+			right->mNext->mPrev = left;
+		}
+		else
+		{
+			mLast = left;
+		}
+		DeleteNode(right);
+	}
+
+	void RebalanceInner(Path& path, uint32_t level)
+	{
+		Inner* node = path.mNodes[level];
+		if (level == 0)
+		{
+			if (node->mCount == 0)
+			{
+				mRoot = node->mChildren[0];
+				DeleteNode(node);
+			}
+			return;
+		}
+		if (node->mCount >= InnerMin)
+		{
+			return;
+		}
+
+		Inner* parent = path.mNodes[level - 1];
+		const uint32_t index = path.mIndices[level - 1];
+		Inner* left = index > 0 ? static_cast<Inner*>(parent->mChildren[index - 1]) : nullptr;
+		Inner* right = index < parent->mCount ? static_cast<Inner*>(parent->mChildren[index + 1]) : nullptr;
+		if (left && left->mCount > InnerMin)
+		{
+			// Rotate last child of left sibling through parent
+			detail::BTreeOpenGap(node->mKeys.Data(), 0, node->mCount);
+			node->mKeys.Insert(0, std::move(parent->mKeys[index - 1]));
+			std::memmove(node->mChildren + 1, node->mChildren, (node->mCount + 1) * sizeof(Node*));
+			node->mChildren[0] = left->mChildren[left->mCount];
+			node->mCount++;
+			parent->mKeys[index - 1] = std::move(left->mKeys[left->mCount - 1]);
+			left->mKeys.Erase(left->mCount - 1);
+			left->mCount--;
+		}
+		else if (right && right->mCount > InnerMin)
+		{
+			// Rotate first child of right sibling through parent
+			node->mKeys.Insert(node->mCount, std::move(parent->mKeys[index]));
+			node->mChildren[node->mCount + 1] = right->mChildren[0];
+			node->mCount++;
+			parent->mKeys[index] = std::move(right->mKeys[0]);
+			right->mKeys.Erase(0);
+			detail::BTreeCloseGap(right->mKeys.Data(), 0, right->mCount);
+			std::memmove(right->mChildren, right->mChildren + 1, right->mCount * sizeof(Node*));
+			right->mCount--;
+		}
+		else if (left)
+		{
+			MergeInner(left, parent->mKeys[index - 1], node);
+			RemoveFromInner(parent, index - 1);
+			RebalanceInner(path, level - 1);
+		}
+		else
+		{
+			MergeInner(node, parent->mKeys[index], right);
+			RemoveFromInner(parent, index);
+			RebalanceInner(path, level - 1);
+		}
+	}
+
+	// Moves separator and all of right node to left node
+	void MergeInner(Inner* left, TKey& separator, Inner* right)
+	{
+		left->mKeys.Insert(left->mCount, std::move(separator));
+		ion::Relocate(left->mKeys.Data() + left->mCount + 1, right->mKeys.Data(), right->mCount);
+		std::memcpy(left->mChildren + left->mCount + 1, right->mChildren, (right->mCount + 1) * sizeof(Node*));
+		left->mCount += right->mCount + 1;
+		DeleteNode(right);
+	}
+
+	Leaf* NewLeaf()
+	{
+		Leaf* leaf = new (mAllocator.AllocateRaw(sizeof(Leaf), NodeAlignment)) Leaf;
+		leaf->mCount = 0;
+		leaf->mIsLeaf = true;
+		leaf->mPrev = nullptr;
+		leaf->mNext = nullptr;
+		return leaf;
+	}
+
+	Inner* NewInner()
+	{
+		Inner* inner = new (mAllocator.AllocateRaw(sizeof(Inner), NodeAlignment)) Inner;
+		inner->mCount = 0;
+		inner->mIsLeaf = false;
+		return inner;
+	}
+
+	void DeleteNode(Node* node) { mAllocator.DeallocateRaw(node, node->mIsLeaf ? sizeof(Leaf) : sizeof(Inner), NodeAlignment); }
+
+	void FreeSubtree(Node* node)
+	{
+		if (node->mIsLeaf)
+		{
+			Leaf* leaf = static_cast<Leaf*>(node);
+			for (uint32_t i = 0; i < leaf->mCount; ++i)
+			{
+				leaf->mKeys.Erase(i);
+				if constexpr (HasValues)
+				{
+					leaf->mValues.Erase(i);
+				}
+			}
+		}
+		else
+		{
+			Inner* inner = static_cast<Inner*>(node);
+			for (uint32_t i = 0; i < inner->mCount; ++i)
+			{
+				inner->mKeys.Erase(i);
+			}
+			for (uint32_t i = 0; i <= inner->mCount; ++i)
+			{
+				FreeSubtree(inner->mChildren[i]);
+			}
+		}
+		DeleteNode(node);
+	}
+
+	void CopyFrom(const BTree& other)
+	{
+		ConstIterator iter = other.Begin();
+		BuildFrom(other.mSize,
+				  [&](TKey* key, [[maybe_unused]] TValue* value)
+				  {
+					  new (static_cast<void*>(key)) TKey(iter.Key());
+					  if constexpr (HasValues)
+					  {
+						  new (static_cast<void*>(value)) TValue(iter.Value());
+					  }
+					  ++iter;
+				  });
+	}
+
+	void Steal(BTree& other)
+	{
+		mRoot = other.mRoot;
+		mFirst = other.mFirst;
+		mLast = other.mLast;
+		mSize = other.mSize;
+		other.mRoot = nullptr;
+		other.mFirst = nullptr;
+		other.mLast = nullptr;
+		other.mSize = 0;
+	}
+
+	Node* mRoot = nullptr;
+	Leaf* mFirst = nullptr;
+	Leaf* mLast = nullptr;
+	size_t mSize = 0;
+	NodeAllocator mAllocator;
+};
+}  // namespace detail
+
+// Ordered map implemented as B+tree.
+//
+// Entries are stored in leaves of NodeSize bytes that are linked in key order, thus ordered and range iteration read
+// consecutive keys from few cache lines instead of chasing a pointer per element like red-black trees do. Default node size
+// is four cache lines. Use larger nodes, e.g. page size, for large maps of small keys. Insert and remove are O(log n) and keep
+// all nodes except root at least half full. Pointers to elements are invalidated by insert and remove.
+template <typename TKey, typename TValue, typename Compare = std::less<TKey>, typename TAllocator = GlobalAllocator<TKey>,
+		  size_t NodeSize = 4 * ION_CONFIG_CACHE_LINE_SIZE>
+class BTreeMap : public detail::BTree<TKey, TValue, Compare, TAllocator, NodeSize>
+{
+	using Super = detail::BTree<TKey, TValue, Compare, TAllocator, NodeSize>;
+
+public:
+	using KeyType = TKey;
+	using ValueType = TValue;
+	using Iterator = typename Super::Iterator;
+	using ConstIterator = typename Super::ConstIterator;
+
+	BTreeMap() {}
+
+	template <typename Resource>
+	BTreeMap(Resource* resource) : Super(resource)
+	{
+	}
+
+	[[nodiscard]] const TValue* Lookup(const TKey& key) const
+	{
+		ConstIterator iter = Super::Find(key);
+		return iter != Super::End() ? &iter.Value() : nullptr;
+	}
+
+	[[nodiscard]] TValue* Lookup(const TKey& key)
+	{
+		Iterator iter = Super::Find(key);
+		return iter != Super::End() ? &iter.Value() : nullptr;
+	}
+
+	const TValue& operator[](const TKey& key) const
+	{
+		const TValue* value = Lookup(key);
+		ION_ASSERT(value, "Key not found");
+		return *value;
+	}
+
+	TValue& operator[](const TKey& key)
+	{
+		TValue* value = Lookup(key);
+		ION_ASSERT(value, "Key not found");
+		return *value;
+	}
+
+	// Inserts value if key is not found. Returns true if value was inserted.
+	template <typename Value>
+	bool Insert(const TKey& key, Value&& value)
+	{
+		return Super::TryEmplace(key, std::forward<Value>(value)).second;
+	}
+
+	// Returns true if value was inserted, false if existing value was replaced.
+	template <typename Value>
+	bool InsertOrAssign(const TKey& key, Value&& value)
+	{
+		if (TValue* existing = Lookup(key))
+		{
+			*existing = std::forward<Value>(value);
+			return false;
+		}
+		Super::TryEmplace(key, std::forward<Value>(value));
+		return true;
+	}
+
+	// Constructs value from arguments if key is not found. Returns iterator to element and true if value was inserted.
+	template <typename... Args>
+	std::pair<Iterator, bool> Emplace(const TKey& key, Args&&... args)
+	{
+		return Super::TryEmplace(key, std::forward<Args>(args)...);
+	}
+
+	// Replaces contents with key-value pairs [first, last) that are sorted by key and have unique keys. O(n).
+	template <typename InputIterator>
+	void BuildSorted(InputIterator first, InputIterator last)
+	{
+		Super::BuildFrom(size_t(std::distance(first, last)),
+						 [&](TKey* key, TValue* value)
+						 {
+							 new (static_cast<void*>(key)) TKey(first->first);
+							 new (static_cast<void*>(value)) TValue(first->second);
+							 ++first;
+						 });
+	}
+};
+
+// Ordered set implemented as B+tree. See BTreeMap.
+template <typename TKey, typename Compare = std::less<TKey>, typename TAllocator = GlobalAllocator<TKey>,
+		  size_t NodeSize = 4 * ION_CONFIG_CACHE_LINE_SIZE>
+class BTreeSet : public detail::BTree<TKey, detail::BTreeNoValue, Compare, TAllocator, NodeSize>
+{
+	using Super = detail::BTree<TKey, detail::BTreeNoValue, Compare, TAllocator, NodeSize>;
+
+public:
+	using ElementType = TKey;
+
+	BTreeSet() {}
+
+	template <typename Resource>
+	BTreeSet(Resource* resource) : Super(resource)
+	{
+	}
+
+	// Returns true if key was inserted
+	bool Add(const TKey& key) { return Super::TryEmplace(key).second; }
+
+	// Replaces contents with keys [first, last) that are sorted and unique. O(n).
+	template <typename InputIterator>
+	void BuildSorted(InputIterator first, InputIterator last)
+	{
+		Super::BuildFrom(size_t(std::distance(first, last)),
+						 [&](TKey* key, detail::BTreeNoValue*)
+						 {
+							 new (static_cast<void*>(key)) TKey(*first);
+							 ++first;
+						 });
+	}
+};
+}  // namespace ion
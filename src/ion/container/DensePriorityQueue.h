@@ -19,17 +19,26 @@
 #include <ion/container/Algorithm.h>
 #include <ion/container/Vector.h>
 
+#include <ion/memory/GlobalAllocator.h>
+
 namespace ion
 {
-// Priority queue where most of the elements have same priority
-// #TODO: Support allocators
-template <typename TValue, typename TIndex, size_t TShortRange, size_t TShortAllocation = 8>
+// Priority queue where most of the elements have same priority. For monotone integer priorities spread over a wide range
+// see RadixHeap.
+template <typename TValue, typename TIndex, size_t TShortRange, size_t TShortAllocation = 8,
+		  typename TAllocator = ion::GlobalAllocator<TValue>>
 class DensePriorityQueue
 {
 public:
+	using List = ion::Vector<TValue, TAllocator>;
+
 	DensePriorityQueue() : mShortRangeBuffer(), mLongRangeBuffer(), mCurrentIndex(0) {}
 
-	using List = ion::Vector<TValue>;
+	template <typename Resource>
+	DensePriorityQueue(Resource* resource)
+	  : mShortRangeBuffer([&](size_t) { return List(resource); }), mLongRangeBuffer(resource), mCurrentIndex(0)
+	{
+	}
 
 	DensePriorityQueue& operator=(const DensePriorityQueue& other)
 	{
@@ -213,7 +222,7 @@ private:
 	}
 
 	ion::Array<List, TShortRange> mShortRangeBuffer;
-	ion::PriorityQueue<TValue> mLongRangeBuffer;
+	ion::PriorityQueue<TValue, TAllocator> mLongRangeBuffer;
 	TIndex mCurrentIndex;
 };
 }  // namespace ion
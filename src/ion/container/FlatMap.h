@@ -0,0 +1,342 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/container/ArrayView.h>
+#include <ion/container/FlatSearch.h>
+#include <ion/container/Sort.h>
+#include <ion/container/Vector.h>
+
+#include <ion/memory/GlobalAllocator.h>
+
+#include <algorithm>  // std::rotate
+#include <memory>	  // std::allocator_traits
+#include <utility>
+
+namespace ion
+{
+namespace detail
+{
+// Sorts items by key and removes duplicates. Last item of duplicated keys is kept.
+template <typename Item, typename KeyOf, typename Compare>
+void FlatSortUnique(Vector<Item>& items, KeyOf&& keyOf, const Compare& less)
+{
+	const size_t size = items.Size();
+	Vector<uint32_t> order;
+	order.Resize(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		order[i] = uint32_t(i);
+	}
+	ion::Sort(order.Begin(), order.End(),
+			  [&](uint32_t a, uint32_t b)
+			  {
+				  if (less(keyOf(items[a]), keyOf(items[b])))
+				  {
+					  return true;
+				  }
+				  if (less(keyOf(items[b]), keyOf(items[a])))
+				  {
+					  return false;
+				  }
+				  return a < b;
+			  });
+
+	Vector<Item> result;
+	result.Reserve(size);
+	for (size_t i = 0; i < size; ++i)
+	{
+		if (i + 1 < size && !less(keyOf(items[order[i]]), keyOf(items[order[i + 1]])))
+		{
+			continue;
+		}
+		result.Add(std::move(items[order[i]]));
+	}
+	items = std::move(result);
+}
+}  // namespace detail
+
+// Sorted map storing keys and values in separate contiguous arrays.
+//
+// Lookups search only the key array, small maps of arithmetic keys are scanned with SIMD instructions and larger maps use
+// branchless binary search. Intended for small or read-mostly maps, single insert and remove are O(n). Use Build() or
+// MergeInsert() to insert many elements at once.
+template <typename TKey, typename TValue, typename Compare = std::less<TKey>, typename TAllocator = GlobalAllocator<TKey>>
+class FlatMap
+{
+	using ValueAllocator = typename std::allocator_traits<TAllocator>::template rebind_alloc<TValue>;
+
+public:
+	using KeyType = TKey;
+	using ValueType = TValue;
+
+	FlatMap() {}
+
+	template <typename Resource>
+	FlatMap(Resource* resource) : mKeys(resource), mValues(resource)
+	{
+	}
+
+	[[nodiscard]] size_t Size() const { return mKeys.Size(); }
+
+	[[nodiscard]] bool IsEmpty() const { return mKeys.IsEmpty(); }
+
+	void Clear()
+	{
+		mKeys.Clear();
+		mValues.Clear();
+	}
+
+	void Reserve(size_t size)
+	{
+		mKeys.Reserve(size);
+		mValues.Reserve(size);
+	}
+
+	void ShrinkToFit()
+	{
+		mKeys.ShrinkToFit();
+		mValues.ShrinkToFit();
+	}
+
+	// Index of first key not less than given key
+	[[nodiscard]] size_t LowerBound(const TKey& key) const { return ion::FlatLowerBound(mKeys.Data(), mKeys.Size(), key, mLess); }
+
+	// Index of key or Size() when not found
+	[[nodiscard]] size_t IndexOf(const TKey& key) const
+	{
+		size_t index = LowerBound(key);
+		return (index != Size() && !mLess(key, mKeys[index])) ? index : Size();
+	}
+
+	[[nodiscard]] bool Contains(const TKey& key) const { return IndexOf(key) != Size(); }
+
+	[[nodiscard]] const TValue* Lookup(const TKey& key) const
+	{
+		size_t index = IndexOf(key);
+		return index != Size() ? &mValues[index] : nullptr;
+	}
+
+	[[nodiscard]] TValue* Lookup(const TKey& key)
+	{
+		size_t index = IndexOf(key);
+		return index != Size() ? &mValues[index] : nullptr;
+	}
+
+	const TValue& operator[](const TKey& key) const
+	{
+		const TValue* value = Lookup(key);
+		ION_ASSERT(value, "Key not found");
+		return *value;
+	}
+
+	TValue& operator[](const TKey& key)
+	{
+		TValue* value = Lookup(key);
+		ION_ASSERT(value, "Key not found");
+		return *value;
+	}
+
+	[[nodiscard]] const TKey& Key(size_t index) const { return mKeys[index]; }
+
+	[[nodiscard]] const TValue& Value(size_t index) const { return mValues[index]; }
+
+	[[nodiscard]] TValue& Value(size_t index) { return mValues[index]; }
+
+	[[nodiscard]] ArrayView<const TKey, size_t> Keys() const { return ArrayView<const TKey, size_t>(mKeys.Data(), mKeys.Size()); }
+
+	[[nodiscard]] ArrayView<const TValue, size_t> Values() const
+	{
+		return ArrayView<const TValue, size_t>(mValues.Data(), mValues.Size());
+	}
+
+	[[nodiscard]] ArrayView<TValue, size_t> Values() { return ArrayView<TValue, size_t>(mValues.Data(), mValues.Size()); }
+
+	// Inserts value if key is not found. Returns true if value was inserted.
+	template <typename Value>
+	bool Insert(const TKey& key, Value&& value)
+	{
+		size_t index = LowerBound(key);
+		if (index != Size() && !mLess(key, mKeys[index]))
+		{
+			return false;
+		}
+		InsertAt(index, key, std::forward<Value>(value));
+		return true;
+	}
+
+	// Returns true if value was inserted, false if existing value was replaced.
+	template <typename Value>
+	bool InsertOrAssign(const TKey& key, Value&& value)
+	{
+		size_t index = LowerBound(key);
+		if (index != Size() && !mLess(key, mKeys[index]))
+		{
+			mValues[index] = std::forward<Value>(value);
+			return false;
+		}
+		InsertAt(index, key, std::forward<Value>(value));
+		return true;
+	}
+
+	// Returns true if key was found and removed
+	bool Remove(const TKey& key)
+	{
+		size_t index = IndexOf(key);
+		if (index == Size())
+		{
+			return false;
+		}
+		RemoveAt(index);
+		return true;
+	}
+
+	void RemoveAt(size_t index)
+	{
+		mKeys.Erase(index);
+		mValues.Erase(index);
+	}
+
+	// Replaces contents with unsorted key-value pairs. When keys are duplicated, last value is used.
+	template <typename Iterator>
+	void Build(Iterator first, Iterator last)
+	{
+		Vector<std::pair<TKey, TValue>> items;
+		CollectSorted(items, first, last);
+		Clear();
+		Reserve(items.Size());
+		for (auto& item : items)
+		{
+			mKeys.Add(std::move(item.first));
+			mValues.Add(std::move(item.second));
+		}
+	}
+
+	// Inserts or assigns a batch of unsorted key-value pairs. Batch is sorted and merged to existing elements in O(n + m log m).
+	template <typename Iterator>
+	void MergeInsert(Iterator first, Iterator last)
+	{
+		Vector<std::pair<TKey, TValue>> items;
+		CollectSorted(items, first, last);
+		if (items.IsEmpty())
+		{
+			return;
+		}
+
+		const size_t oldSize = Size();
+		size_t newSize = oldSize;
+		{
+			size_t i = 0;
+			size_t j = 0;
+			while (j < items.Size())
+			{
+				if (i < oldSize && mLess(mKeys[i], items[j].first))
+				{
+					++i;
+				}
+				else
+				{
+					if (i < oldSize && !mLess(items[j].first, mKeys[i]))
+					{
+						++i;
+					}
+					else
+					{
+						++newSize;
+					}
+					++j;
+				}
+			}
+		}
+
+		// Merge from back to front so that existing elements are moved at most once
+		mKeys.Resize(newSize);
+		mValues.Resize(newSize);
+		size_t i = oldSize;
+		size_t j = items.Size();
+		size_t w = newSize;
+		while (j > 0)
+		{
+			--w;
+			if (i > 0 && mLess(items[j - 1].first, mKeys[i - 1]))
+			{
+				--i;
+				mKeys[w] = std::move(mKeys[i]);
+				mValues[w] = std::move(mValues[i]);
+			}
+			else
+			{
+				--j;
+				if (i > 0 && !mLess(mKeys[i - 1], items[j].first))
+				{
+					// Same key, batch value replaces existing value
+					--i;
+				}
+				mKeys[w] = std::move(items[j].first);
+				mValues[w] = std::move(items[j].second);
+			}
+		}
+		ION_ASSERT(w == i, "Invalid merge");
+	}
+
+	// Calls callback(const TKey&, TValue&) for each element in key order
+	template <typename Callback>
+	void ForEach(Callback&& callback)
+	{
+		for (size_t i = 0; i < Size(); ++i)
+		{
+			callback(mKeys[i], mValues[i]);
+		}
+	}
+
+	template <typename Callback>
+	void ForEach(Callback&& callback) const
+	{
+		for (size_t i = 0; i < Size(); ++i)
+		{
+			callback(mKeys[i], mValues[i]);
+		}
+	}
+
+private:
+	template <typename Value>
+	void InsertAt(size_t index, const TKey& key, Value&& value)
+	{
+		mKeys.Add(key);
+		mValues.Add(TValue(std::forward<Value>(value)));
+		if (index + 1 != mKeys.Size())
+		{
+			std::rotate(mKeys.Begin() + index, mKeys.End() - 1, mKeys.End());
+			std::rotate(mValues.Begin() + index, mValues.End() - 1, mValues.End());
+		}
+	}
+
+	template <typename Iterator>
+	void CollectSorted(Vector<std::pair<TKey, TValue>>& items, Iterator first, Iterator last)
+	{
+		for (; first != last; ++first)
+		{
+			items.Add(std::pair<TKey, TValue>(first->first, first->second));
+		}
+		detail::FlatSortUnique(
+		  items, [](const std::pair<TKey, TValue>& item) -> const TKey& { return item.first; }, mLess);
+	}
+
+	Vector<TKey, TAllocator> mKeys;
+	Vector<TValue, ValueAllocator> mValues;
+	Compare mLess;
+};
+}  // namespace ion
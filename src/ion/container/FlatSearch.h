@@ -0,0 +1,124 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/Base.h>
+#include <ion/hw/CPU.h>
+#include <ion/util/Bits.h>
+
+#include <functional>  // std::less
+#include <type_traits>
+
+#if ION_CPU_SSE2_ASSUMED
+	#include <emmintrin.h>
+#elif ION_CPU_NEON_ASSUMED
+	#include <arm_neon.h>
+#endif
+
+// Lower bound searches for sorted arrays
+namespace ion
+{
+// Arrays up to this size are scanned linearly when keys can be compared with SIMD instructions
+constexpr size_t FlatScanLimit = 32;
+
+// Binary search without data dependent branches. Loop count depends only on size, thus there are no branch mispredictions
+// and compiler can use conditional moves.
+template <typename T, typename Compare>
+[[nodiscard]] inline size_t LowerBoundBranchless(const T* data, size_t size, const T& key, const Compare& less)
+{
+	if (size == 0)
+	{
+		return 0;
+	}
+	const T* base = data;
+	while (size > 1)
+	{
+		const size_t half = size / 2;
+		base = less(base[half], key) ? base + half : base;
+		size -= half;
+	}
+	return size_t(base - data) + (less(*base, key) ? 1 : 0);
+}
+
+// Linear scan counting keys less than given key
+template <typename T>
+[[nodiscard]] inline size_t LowerBoundScan(const T* data, size_t size, const T& key)
+{
+	size_t i = 0;
+#if ION_CPU_SSE2_ASSUMED || ION_CPU_NEON_ASSUMED
+	if constexpr (std::is_integral_v<T> && sizeof(T) == 4)
+	{
+	#if ION_CPU_SSE2_ASSUMED
+		// SSE2 has only signed comparison, unsigned values are biased to signed range
+		const int32_t bias = std::is_signed_v<T> ? 0 : INT32_MIN;
+		const __m128i biasVec = _mm_set1_epi32(bias);
+		const __m128i keyVec = _mm_set1_epi32(int32_t(key) ^ bias);
+		for (; i + 4 <= size; i += 4)
+		{
+			__m128i values = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)), biasVec);
+			int mask = _mm_movemask_epi8(_mm_cmplt_epi32(values, keyVec));
+			if (mask != 0xFFFF)
+			{
+				// Keys are sorted, thus matching lanes are first lanes
+				return i + size_t(ion::CountTrailingZeroes(uint32_t(~mask))) / 4;
+			}
+		}
+	#else
+		for (; i + 4 <= size; i += 4)
+		{
+			uint32x4_t lessThan;
+			if constexpr (std::is_signed_v<T>)
+			{
+				lessThan = vcltq_s32(vld1q_s32(reinterpret_cast<const int32_t*>(data + i)), vdupq_n_s32(int32_t(key)));
+			}
+			else
+			{
+				lessThan = vcltq_u32(vld1q_u32(reinterpret_cast<const uint32_t*>(data + i)), vdupq_n_u32(uint32_t(key)));
+			}
+			uint32_t count = vaddvq_u32(vshrq_n_u32(lessThan, 31));
+			if (count != 4)
+			{
+				return i + count;
+			}
+		}
+	#endif
+	}
+#endif
+	for (; i < size; ++i)
+	{
+		if (!(data[i] < key))
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+// Lower bound using linear scan for small arrays of arithmetic keys and branchless binary search otherwise
+template <typename T, typename Compare = std::less<T>>
+[[nodiscard]] inline size_t FlatLowerBound(const T* data, size_t size, const T& key, const Compare& less = Compare())
+{
+	if constexpr (std::is_arithmetic_v<T> && std::is_same_v<Compare, std::less<T>>)
+	{
+		if (size <= FlatScanLimit)
+		{
+			return LowerBoundScan(data, size, key);
+		}
+	}
+	return LowerBoundBranchless(data, size, key, less);
+}
+
+}  // namespace ion
@@ -0,0 +1,191 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/container/FlatMap.h>
+
+namespace ion
+{
+// Sorted set storing keys in a contiguous array. See FlatMap.
+template <typename TKey, typename Compare = std::less<TKey>, typename TAllocator = GlobalAllocator<TKey>>
+class FlatSet
+{
+public:
+	using ElementType = TKey;
+	using ConstIterator = const TKey*;
+
+	FlatSet() {}
+
+	template <typename Resource>
+	FlatSet(Resource* resource) : mKeys(resource)
+	{
+	}
+
+	[[nodiscard]] size_t Size() const { return mKeys.Size(); }
+
+	[[nodiscard]] bool IsEmpty() const { return mKeys.IsEmpty(); }
+
+	void Clear() { mKeys.Clear(); }
+
+	void Reserve(size_t size) { mKeys.Reserve(size); }
+
+	void ShrinkToFit() { mKeys.ShrinkToFit(); }
+
+	// Index of first key not less than given key
+	[[nodiscard]] size_t LowerBound(const TKey& key) const { return ion::FlatLowerBound(mKeys.Data(), mKeys.Size(), key, mLess); }
+
+	// Index of key or Size() when not found
+	[[nodiscard]] size_t IndexOf(const TKey& key) const
+	{
+		size_t index = LowerBound(key);
+		return (index != Size() && !mLess(key, mKeys[index])) ? index : Size();
+	}
+
+	[[nodiscard]] bool Contains(const TKey& key) const { return IndexOf(key) != Size(); }
+
+	[[nodiscard]] const TKey& operator[](size_t index) const { return mKeys[index]; }
+
+	[[nodiscard]] const TKey* Data() const { return mKeys.Data(); }
+
+	[[nodiscard]] ConstIterator Begin() const { return mKeys.Data(); }
+
+	[[nodiscard]] ConstIterator End() const { return mKeys.Data() + mKeys.Size(); }
+
+	[[nodiscard]] ConstIterator begin() const { return Begin(); }
+
+	[[nodiscard]] ConstIterator end() const { return End(); }
+
+	// Returns true if key was inserted
+	bool Add(const TKey& key)
+	{
+		size_t index = LowerBound(key);
+		if (index != Size() && !mLess(key, mKeys[index]))
+		{
+			return false;
+		}
+		mKeys.Add(key);
+		if (index + 1 != mKeys.Size())
+		{
+			std::rotate(mKeys.Begin() + index, mKeys.End() - 1, mKeys.End());
+		}
+		return true;
+	}
+
+	// Returns true if key was found and removed
+	bool Remove(const TKey& key)
+	{
+		size_t index = IndexOf(key);
+		if (index == Size())
+		{
+			return false;
+		}
+		mKeys.Erase(index);
+		return true;
+	}
+
+	// Replaces contents with unsorted keys
+	template <typename Iterator>
+	void Build(Iterator first, Iterator last)
+	{
+		Vector<TKey> items;
+		CollectSorted(items, first, last);
+		Clear();
+		Reserve(items.Size());
+		for (auto& item : items)
+		{
+			mKeys.Add(std::move(item));
+		}
+	}
+
+	// Inserts a batch of unsorted keys. Batch is sorted and merged to existing keys in O(n + m log m).
+	template <typename Iterator>
+	void MergeInsert(Iterator first, Iterator last)
+	{
+		Vector<TKey> items;
+		CollectSorted(items, first, last);
+		if (items.IsEmpty())
+		{
+			return;
+		}
+
+		const size_t oldSize = Size();
+		size_t newSize = oldSize;
+		{
+			size_t i = 0;
+			size_t j = 0;
+			while (j < items.Size())
+			{
+				if (i < oldSize && mLess(mKeys[i], items[j]))
+				{
+					++i;
+				}
+				else
+				{
+					if (i < oldSize && !mLess(items[j], mKeys[i]))
+					{
+						++i;
+					}
+					else
+					{
+						++newSize;
+					}
+					++j;
+				}
+			}
+		}
+
+		// Merge from back to front so that existing keys are moved at most once
+		mKeys.Resize(newSize);
+		size_t i = oldSize;
+		size_t j = items.Size();
+		size_t w = newSize;
+		while (j > 0)
+		{
+			--w;
+			if (i > 0 && mLess(items[j - 1], mKeys[i - 1]))
+			{
+				--i;
+				mKeys[w] = std::move(mKeys[i]);
+			}
+			else
+			{
+				--j;
+				if (i > 0 && !mLess(mKeys[i - 1], items[j]))
+				{
+					--i;
+				}
+				mKeys[w] = std::move(items[j]);
+			}
+		}
+		ION_ASSERT(w == i, "Invalid merge");
+	}
+
+private:
+	template <typename Iterator>
+	void CollectSorted(Vector<TKey>& items, Iterator first, Iterator last)
+	{
+		for (; first != last; ++first)
+		{
+			items.Add(*first);
+		}
+		detail::FlatSortUnique(
+		  items, [](const TKey& item) -> const TKey& { return item; }, mLess);
+	}
+
+	Vector<TKey, TAllocator> mKeys;
+	Compare mLess;
+};
+}  // namespace ion
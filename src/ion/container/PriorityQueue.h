@@ -20,12 +20,19 @@
 
 namespace ion
 {
-template <typename TValue>
+template <typename TValue, typename TAllocator = std::allocator<TValue>>
 class PriorityQueue
 {
+	using Container = std::vector<TValue, TAllocator>;
+
 public:
 	PriorityQueue(size_t reserve = 0)
-	: mImpl(std::less<TValue>(), reserve > 0 ? std::move(createContainer(reserve)) : std::move(std::vector<TValue>()))
+	: mImpl(std::less<TValue>(), reserve > 0 ? std::move(createContainer(reserve)) : std::move(Container()))
+	{
+	}
+
+	template <typename Resource>
+	PriorityQueue(Resource* resource) : mImpl(std::less<TValue>(), Container(TAllocator(resource)))
 	{
 	}
 
@@ -52,10 +59,10 @@ public:
 	[[nodiscard]] inline size_t Size() const { return mImpl.size(); }
 
 private:
-	std::priority_queue<TValue, std::vector<TValue>> mImpl;
-	inline std::vector<TValue> createContainer(size_t reserve)
+	std::priority_queue<TValue, Container> mImpl;
+	inline Container createContainer(size_t reserve)
 	{
-		std::vector<TValue> container;
+		Container container;
 		container.reserve(reserve);
 		return container;
 	}
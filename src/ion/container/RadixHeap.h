@@ -0,0 +1,223 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/container/Array.h>
+#include <ion/container/Vector.h>
+
+#include <ion/memory/GlobalAllocator.h>
+
+#include <ion/util/Bits.h>
+#include <ion/util/Math.h>
+
+#include <type_traits>
+
+namespace ion
+{
+// Monotone priority queue for unsigned integer priorities. Lowest priority is on top.
+//
+// Elements are stored in buckets by the highest bit that differs from the last popped priority. When bucket of the last
+// popped priority runs out, the lowest non-empty bucket is found using bit scan and its elements are redistributed to lower
+// buckets. Each element is moved at most once per bit of priority, thus push and pop are amortized O(1) for practical
+// priority types, compared to O(log n) of PriorityQueue.
+//
+// Pushed priority must not be less than priority of the last popped element unless the queue is empty. This holds for
+// example for timestamps of events scheduled by event processing. Priority is read using TValue::GetPriority() like in
+// DensePriorityQueue.
+template <typename TValue, typename TPriority = uint64_t, typename TAllocator = ion::GlobalAllocator<TValue>>
+class RadixHeap
+{
+	static_assert(std::is_unsigned_v<TPriority>, "Unsigned priority expected");
+	static constexpr uint32_t PriorityBits = sizeof(TPriority) * 8;
+	static_assert(PriorityBits <= 64, "Unsupported priority type");
+
+	// Bucket 0 has elements with priority of the last popped element, bucket N has elements whose highest differing bit is N-1
+	static constexpr uint32_t NumBuckets = PriorityBits + 1;
+
+public:
+	using List = ion::Vector<TValue, TAllocator>;
+
+	RadixHeap() {}
+
+	template <typename Resource>
+	RadixHeap(Resource* resource) : mBuckets([&](size_t) { return List(resource); })
+	{
+	}
+
+	[[nodiscard]] bool IsEmpty() const { return mSize == 0; }
+
+	[[nodiscard]] size_t Size() const { return mSize; }
+
+	void Push(const TValue& element)
+	{
+		const TPriority priority = element.GetPriority();
+		ResetIfEmpty(priority);
+		ION_ASSERT(priority >= mLast, "Priority " << priority << " less than last popped priority " << mLast);
+		AddToBucket(BucketOf(priority), element);
+		mSize++;
+	}
+
+	void Push(TValue&& element)
+	{
+		const TPriority priority = element.GetPriority();
+		ResetIfEmpty(priority);
+		ION_ASSERT(priority >= mLast, "Priority " << priority << " less than last popped priority " << mLast);
+		AddToBucket(BucketOf(priority), std::move(element));
+		mSize++;
+	}
+
+	// Pushes elements [first, last). Buckets are reserved before adding, thus each bucket grows at most once.
+	template <typename Iterator>
+	void Push(Iterator first, Iterator last)
+	{
+		if (first == last)
+		{
+			return;
+		}
+		if (mSize == 0)
+		{
+			for (Iterator iter = first; iter != last; ++iter)
+			{
+				ResetIfEmpty(iter->GetPriority());
+			}
+		}
+		uint32_t counts[NumBuckets] = {};
+		for (Iterator iter = first; iter != last; ++iter)
+		{
+			ION_ASSERT(iter->GetPriority() >= mLast, "Priority " << iter->GetPriority() << " less than last popped priority " << mLast);
+			counts[BucketOf(iter->GetPriority())]++;
+		}
+		for (uint32_t i = 0; i < NumBuckets; ++i)
+		{
+			if (counts[i] != 0)
+			{
+				mBuckets[i].Reserve(mBuckets[i].Size() + counts[i]);
+				mSize += counts[i];
+			}
+		}
+		for (Iterator iter = first; iter != last; ++iter)
+		{
+			AddToBucket(BucketOf(iter->GetPriority()), *iter);
+		}
+	}
+
+	// Element of lowest priority. Not const, because buckets may be redistributed.
+	[[nodiscard]] TValue& Top()
+	{
+		ION_ASSERT(!IsEmpty(), "No elements left");
+		Refill();
+		return mBuckets[0].Back();
+	}
+
+	[[nodiscard]] TPriority TopPriority()
+	{
+		ION_ASSERT(!IsEmpty(), "No elements left");
+		Refill();
+		return mLast;
+	}
+
+	void Pop()
+	{
+		ION_ASSERT(!IsEmpty(), "No elements left");
+		Refill();
+		mBuckets[0].Pop();
+		mSize--;
+	}
+
+	// All elements of lowest priority in no specific order
+	[[nodiscard]] List& TopList()
+	{
+		ION_ASSERT(!IsEmpty(), "No elements left");
+		Refill();
+		return mBuckets[0];
+	}
+
+	void PopList()
+	{
+		ION_ASSERT(!IsEmpty(), "No elements left");
+		Refill();
+		mSize -= mBuckets[0].Size();
+		mBuckets[0].Clear();
+	}
+
+	void Clear()
+	{
+		for (uint32_t i = 0; i < NumBuckets; ++i)
+		{
+			mBuckets[i].Clear();
+		}
+		mNonEmptyBuckets = 0;
+		mSize = 0;
+		mLast = 0;
+	}
+
+private:
+	uint32_t BucketOf(TPriority priority) const
+	{
+		const uint64_t diff = uint64_t(priority ^ mLast);
+		return diff == 0 ? 0 : uint32_t(64 - ion::CountLeadingZeroes(diff));
+	}
+
+	template <typename Element>
+	void AddToBucket(uint32_t bucket, Element&& element)
+	{
+		if (bucket != 0)
+		{
+			mNonEmptyBuckets |= uint64_t(1) << (bucket - 1);
+		}
+		mBuckets[bucket].Add(std::forward<Element>(element));
+	}
+
+	void ResetIfEmpty(TPriority priority)
+	{
+		if (mSize == 0 && priority < mLast)
+		{
+			// No elements to keep in order, lower priorities can be accepted
+			mLast = priority;
+		}
+	}
+
+	// Moves elements of lowest non-empty bucket to lower buckets if there are no elements left of the last popped priority
+	void Refill()
+	{
+		if (!mBuckets[0].IsEmpty())
+		{
+			return;
+		}
+		ION_ASSERT(mNonEmptyBuckets != 0, "Invalid bucket state");
+		const uint32_t bucket = uint32_t(ion::CountTrailingZeroes(mNonEmptyBuckets)) + 1;
+		List& source = mBuckets[bucket];
+		TPriority minPriority = source[0].GetPriority();
+		for (size_t i = 1; i < source.Size(); ++i)
+		{
+			minPriority = ion::Min(minPriority, TPriority(source[i].GetPriority()));
+		}
+		mLast = minPriority;
+		mNonEmptyBuckets &= ~(uint64_t(1) << (bucket - 1));
+		// All elements share bits above the bucket, thus they move to strictly lower buckets
+		for (size_t i = 0; i < source.Size(); ++i)
+		{
+			AddToBucket(BucketOf(source[i].GetPriority()), std::move(source[i]));
+		}
+		source.Clear();
+	}
+
+	ion::Array<List, NumBuckets> mBuckets;
+	uint64_t mNonEmptyBuckets = 0;	// Bit N-1 is set when bucket N has elements
+	size_t mSize = 0;
+	TPriority mLast = 0;
+};
+}  // namespace ion
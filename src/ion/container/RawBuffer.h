@@ -151,9 +151,9 @@ public:
 	// Move part of contents to given byte sequence
 	inline void MoveTo(Value* ION_RESTRICT destination, size_t size)
 	{
-		if constexpr (std::is_trivially_copyable<Value>::value)
+		if constexpr (IsTriviallyRelocatableV<Value>)
 		{
-			ion::Copy(mData, &mData[size], destination);
+			ion::Relocate(destination, mData, size);
 #if ION_BUILD_DEBUG_DYNAMIC_BUFFER
 			if constexpr (!IsTrivial())
 			{
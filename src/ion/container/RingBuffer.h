@@ -90,7 +90,7 @@ public:
 	ION_INLINE void PushBack(T&& val)
 	{
 		ION_ASSERT(mNumElems < TSize, "Buffer overflow");
-		mBuffer.Insert(Mod(mReadPos + mNumElems), val);
+		mBuffer.Insert(Mod(mReadPos + mNumElems), std::move(val));
 		mNumElems++;
 	}
 
@@ -0,0 +1,323 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/memory/GlobalAllocator.h>
+
+#include <ion/util/Bits.h>
+#include <ion/util/Math.h>
+
+#include <iterator>
+#include <utility>
+
+namespace ion
+{
+// Vector storing elements in segments that are never reallocated.
+//
+// First segment has 2^FirstSegmentShift elements and each following segment is twice as large as previous one. Growth
+// allocates only a new segment, thus existing elements are never moved and their addresses stay valid until they are
+// removed. Index is mapped to a segment using position of the highest set bit of (index + first segment size).
+//
+// Use HugePageAllocator for vectors of hundreds of millions of elements.
+template <typename T, typename TAllocator = GlobalAllocator<T>, size_t FirstSegmentShift = 6>
+class SegmentedVector
+{
+	static_assert(FirstSegmentShift < 32, "Invalid first segment size");
+
+public:
+	static constexpr size_t FirstSegmentSize = size_t(1) << FirstSegmentShift;
+	static constexpr size_t MaxSegments = 64 - FirstSegmentShift;
+
+	template <typename Owner, typename Value>
+	class IteratorBase
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = ptrdiff_t;
+		using pointer = Value*;
+		using reference = Value&;
+
+		IteratorBase(Owner* owner, size_t index) : mOwner(owner), mIndex(index) {}
+
+		Value& operator*() const { return (*mOwner)[mIndex]; }
+		Value* operator->() const { return &(*mOwner)[mIndex]; }
+
+		IteratorBase& operator++()
+		{
+			++mIndex;
+			return *this;
+		}
+
+		IteratorBase operator++(int)
+		{
+			IteratorBase result(*this);
+			++mIndex;
+			return result;
+		}
+
+		bool operator==(const IteratorBase& other) const { return mIndex == other.mIndex; }
+		bool operator!=(const IteratorBase& other) const { return mIndex != other.mIndex; }
+
+		size_t Index() const { return mIndex; }
+
+	private:
+		Owner* mOwner;
+		size_t mIndex;
+	};
+
+	using Iterator = IteratorBase<SegmentedVector, T>;
+	using ConstIterator = IteratorBase<const SegmentedVector, const T>;
+
+	SegmentedVector() {}
+
+	template <typename Resource>
+	SegmentedVector(Resource* resource) : mAllocator(resource)
+	{
+	}
+
+	SegmentedVector(const SegmentedVector& other) : mAllocator(other.mAllocator)
+	{
+		Reserve(other.mSize);
+		other.ForEachSegment([&](const T* data, size_t count, size_t) { AppendCopy(data, count); });
+	}
+
+	SegmentedVector(SegmentedVector&& other) noexcept : mAllocator(std::move(other.mAllocator)) { Steal(other); }
+
+	SegmentedVector& operator=(const SegmentedVector& other)
+	{
+		if (this != &other)
+		{
+			Clear();
+			Reserve(other.mSize);
+			other.ForEachSegment([&](const T* data, size_t count, size_t) { AppendCopy(data, count); });
+		}
+		return *this;
+	}
+
+	SegmentedVector& operator=(SegmentedVector&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Free();
+			mAllocator = std::move(other.mAllocator);
+			Steal(other);
+		}
+		return *this;
+	}
+
+	~SegmentedVector() { Free(); }
+
+	[[nodiscard]] size_t Size() const { return mSize; }
+
+	[[nodiscard]] bool IsEmpty() const { return mSize == 0; }
+
+	[[nodiscard]] size_t Capacity() const { return SegmentStart(mNumSegments); }
+
+	[[nodiscard]] T& operator[](size_t index)
+	{
+		ION_ASSERT(index < mSize, "Out of bounds");
+		return *Locate(index);
+	}
+
+	[[nodiscard]] const T& operator[](size_t index) const
+	{
+		ION_ASSERT(index < mSize, "Out of bounds");
+		return *Locate(index);
+	}
+
+	[[nodiscard]] T& Back() { return (*this)[mSize - 1]; }
+	[[nodiscard]] const T& Back() const { return (*this)[mSize - 1]; }
+	[[nodiscard]] T& Front() { return (*this)[0]; }
+	[[nodiscard]] const T& Front() const { return (*this)[0]; }
+
+	[[nodiscard]] Iterator Begin() { return Iterator(this, 0); }
+	[[nodiscard]] Iterator End() { return Iterator(this, mSize); }
+	[[nodiscard]] ConstIterator Begin() const { return ConstIterator(this, 0); }
+	[[nodiscard]] ConstIterator End() const { return ConstIterator(this, mSize); }
+	[[nodiscard]] Iterator begin() { return Begin(); }
+	[[nodiscard]] Iterator end() { return End(); }
+	[[nodiscard]] ConstIterator begin() const { return Begin(); }
+	[[nodiscard]] ConstIterator end() const { return End(); }
+
+	T& Add(const T& data) { return Emplace(data); }
+
+	T& Add(T&& data) { return Emplace(std::move(data)); }
+
+	template <typename... Args>
+	T& Emplace(Args&&... args)
+	{
+		T* slot = PrepareAdd();
+		new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+		mSize++;
+		return *slot;
+	}
+
+	void Pop()
+	{
+		ION_ASSERT(mSize > 0, "Empty");
+		mSize--;
+		Locate(mSize)->~T();
+	}
+
+	void Resize(size_t size)
+	{
+		Reserve(size);
+		while (mSize < size)
+		{
+			Emplace();
+		}
+		while (mSize > size)
+		{
+			Pop();
+		}
+	}
+
+	void Reserve(size_t size)
+	{
+		while (Capacity() < size)
+		{
+			AllocateSegment();
+		}
+	}
+
+	// Destroys elements. Segments are kept for reuse.
+	void Clear()
+	{
+		if constexpr (!std::is_trivially_destructible_v<T>)
+		{
+			ForEachSegment(
+			  [](T* data, size_t count, size_t)
+			  {
+				  for (size_t i = 0; i < count; ++i)
+				  {
+					  data[i].~T();
+				  }
+			  });
+		}
+		mSize = 0;
+	}
+
+	// Releases segments that have no elements
+	void ShrinkToFit()
+	{
+		while (mNumSegments > 0 && SegmentStart(mNumSegments - 1) >= mSize)
+		{
+			mNumSegments--;
+			mAllocator.DeallocateRaw(mSegments[mNumSegments], SegmentSize(mNumSegments) * sizeof(T));
+			mSegments[mNumSegments] = nullptr;
+		}
+	}
+
+	[[nodiscard]] size_t NumSegments() const { return mNumSegments; }
+
+	// Number of elements in use in given segment
+	[[nodiscard]] size_t SegmentCount(size_t segment) const
+	{
+		const size_t start = SegmentStart(segment);
+		return mSize > start ? ion::Min(mSize - start, SegmentSize(segment)) : 0;
+	}
+
+	[[nodiscard]] T* SegmentData(size_t segment) { return mSegments[segment]; }
+	[[nodiscard]] const T* SegmentData(size_t segment) const { return mSegments[segment]; }
+
+	// Calls callback(T* data, size_t count, size_t firstIndex) for each segment that has elements
+	template <typename Callback>
+	void ForEachSegment(Callback&& callback)
+	{
+		for (size_t segment = 0; segment < mNumSegments && SegmentStart(segment) < mSize; ++segment)
+		{
+			callback(mSegments[segment], SegmentCount(segment), SegmentStart(segment));
+		}
+	}
+
+	template <typename Callback>
+	void ForEachSegment(Callback&& callback) const
+	{
+		for (size_t segment = 0; segment < mNumSegments && SegmentStart(segment) < mSize; ++segment)
+		{
+			callback(const_cast<const T*>(mSegments[segment]), SegmentCount(segment), SegmentStart(segment));
+		}
+	}
+
+	static constexpr size_t SegmentSize(size_t segment) { return FirstSegmentSize << segment; }
+
+	// Index of first element of segment
+	static constexpr size_t SegmentStart(size_t segment) { return (FirstSegmentSize << segment) - FirstSegmentSize; }
+
+	static size_t SegmentOf(size_t index)
+	{
+		const uint64_t pos = uint64_t(index) + FirstSegmentSize;
+		return size_t(63 - ion::CountLeadingZeroes(pos)) - FirstSegmentShift;
+	}
+
+private:
+	T* Locate(size_t index) const
+	{
+		const uint64_t pos = uint64_t(index) + FirstSegmentSize;
+		const int highBit = 63 - ion::CountLeadingZeroes(pos);
+		return mSegments[size_t(highBit) - FirstSegmentShift] + size_t(pos ^ (uint64_t(1) << highBit));
+	}
+
+	T* PrepareAdd()
+	{
+		if (mSize == Capacity())
+		{
+			AllocateSegment();
+		}
+		return Locate(mSize);
+	}
+
+	void AllocateSegment()
+	{
+		ION_ASSERT(mNumSegments < MaxSegments, "Out of segments");
+		mSegments[mNumSegments] = reinterpret_cast<T*>(mAllocator.AllocateRaw(SegmentSize(mNumSegments) * sizeof(T)));
+		mNumSegments++;
+	}
+
+	void AppendCopy(const T* data, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			Emplace(data[i]);
+		}
+	}
+
+	void Free()
+	{
+		Clear();
+		ShrinkToFit();
+	}
+
+	void Steal(SegmentedVector& other)
+	{
+		for (size_t i = 0; i < other.mNumSegments; ++i)
+		{
+			mSegments[i] = other.mSegments[i];
+			other.mSegments[i] = nullptr;
+		}
+		mNumSegments = other.mNumSegments;
+		mSize = other.mSize;
+		other.mNumSegments = 0;
+		other.mSize = 0;
+	}
+
+	T* mSegments[MaxSegments] = {};
+	size_t mNumSegments = 0;
+	size_t mSize = 0;
+	TAllocator mAllocator;
+};
+}  // namespace ion
@@ -0,0 +1,280 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/container/ArrayView.h>
+#include <ion/container/Vector.h>
+
+#include <ion/memory/GlobalAllocator.h>
+
+#include <limits>
+#include <memory>  // std::allocator_traits
+#include <utility>
+
+namespace ion
+{
+// Handle to slot map element. Lower 'IndexBits' bits are slot index and remaining bits are generation of the slot.
+template <typename TRaw, uint32_t IndexBits>
+class SlotHandle
+{
+	static_assert(std::is_unsigned_v<TRaw>, "Handle must be unsigned");
+	static_assert(IndexBits > 0 && IndexBits <= 32 && IndexBits < sizeof(TRaw) * 8, "Invalid index bits");
+
+public:
+	using RawType = TRaw;
+	static constexpr uint32_t GenerationBits = sizeof(TRaw) * 8 - IndexBits;
+	static constexpr TRaw IndexMask = (TRaw(1) << IndexBits) - 1;
+	static constexpr TRaw GenerationMask = (std::numeric_limits<TRaw>::max)() >> IndexBits;
+
+	// Largest index is reserved for invalid handle
+	static constexpr uint32_t MaxIndex = uint32_t(IndexMask - 1);
+
+	constexpr SlotHandle() : mRaw((std::numeric_limits<TRaw>::max)()) {}
+
+	constexpr SlotHandle(uint32_t index, TRaw generation) : mRaw((generation << IndexBits) | TRaw(index))
+	{
+		ION_ASSERT_FMT_IMMEDIATE(index <= MaxIndex && generation <= GenerationMask, "Handle out of range");
+	}
+
+	[[nodiscard]] static constexpr SlotHandle FromRaw(TRaw raw)
+	{
+		SlotHandle handle;
+		handle.mRaw = raw;
+		return handle;
+	}
+
+	[[nodiscard]] constexpr uint32_t Index() const { return uint32_t(mRaw & IndexMask); }
+	[[nodiscard]] constexpr TRaw Generation() const { return mRaw >> IndexBits; }
+	[[nodiscard]] constexpr TRaw Raw() const { return mRaw; }
+
+	[[nodiscard]] constexpr bool IsValid() const { return mRaw != (std::numeric_limits<TRaw>::max)(); }
+	constexpr explicit operator bool() const { return IsValid(); }
+
+	constexpr bool operator==(const SlotHandle& other) const { return mRaw == other.mRaw; }
+	constexpr bool operator!=(const SlotHandle& other) const { return mRaw != other.mRaw; }
+	constexpr bool operator<(const SlotHandle& other) const { return mRaw < other.mRaw; }
+
+private:
+	TRaw mRaw;
+};
+
+// 32-bit index and 32-bit generation
+using SlotHandle64 = SlotHandle<uint64_t, 32>;
+
+// 24-bit index and 8-bit generation
+using SlotHandle32 = SlotHandle<uint32_t, 24>;
+
+// Container giving generational handles to its elements.
+//
+// Elements are kept densely packed in a single array, thus iteration is as fast as iterating a vector. Handles are mapped to
+// elements through a slot array. Erasing moves the last element in place of the erased element and increases generation of
+// the erased slot, so old handles to the slot are detected as stale. Free slots are linked in FIFO order through the slot
+// array, which spreads reuse over all free slots. Slot that runs out of generations is retired and not reused.
+//
+// Insert, erase and lookup are O(1). Pointers to elements are invalidated by insert and erase, use handles instead.
+template <typename T, typename THandle = SlotHandle64, typename TAllocator = GlobalAllocator<T>>
+class SlotMap
+{
+	using Generation = std::conditional_t<THandle::GenerationBits <= 8, uint8_t,
+										  std::conditional_t<THandle::GenerationBits <= 16, uint16_t, uint32_t>>;
+	static_assert(THandle::GenerationBits <= 32, "Unsupported handle");
+
+	// Last generation is used for retired slots
+	static constexpr Generation RetiredGeneration = Generation(THandle::GenerationMask);
+
+	struct Slot
+	{
+		uint32_t mIndex;  // Dense index when slot is in use, next free slot when slot is free
+		Generation mGeneration;
+	};
+
+	using SlotAllocator = typename std::allocator_traits<TAllocator>::template rebind_alloc<Slot>;
+	using IndexAllocator = typename std::allocator_traits<TAllocator>::template rebind_alloc<uint32_t>;
+
+	static constexpr uint32_t EndOfList = (std::numeric_limits<uint32_t>::max)();
+
+public:
+	using Handle = THandle;
+	using Iterator = T*;
+	using ConstIterator = const T*;
+
+	SlotMap() {}
+
+	template <typename Resource>
+	SlotMap(Resource* resource) : mValues(resource), mValueSlots(resource), mSlots(resource)
+	{
+	}
+
+	[[nodiscard]] size_t Size() const { return mValues.Size(); }
+
+	[[nodiscard]] bool IsEmpty() const { return mValues.IsEmpty(); }
+
+	void Reserve(size_t size)
+	{
+		mValues.Reserve(size);
+		mValueSlots.Reserve(size);
+		mSlots.Reserve(size);
+	}
+
+	template <typename... Args>
+	Handle Emplace(Args&&... args)
+	{
+		const uint32_t slotIndex = AcquireSlot();
+		Slot& slot = mSlots[slotIndex];
+		slot.mIndex = uint32_t(mValues.Size());
+		mValues.Emplace(std::forward<Args>(args)...);
+		mValueSlots.Add(slotIndex);
+		return Handle(slotIndex, slot.mGeneration);
+	}
+
+	Handle Insert(const T& value) { return Emplace(value); }
+
+	Handle Insert(T&& value) { return Emplace(std::move(value)); }
+
+	// Returns true if handle referred to an element and it was erased
+	bool Erase(Handle handle)
+	{
+		if (!Contains(handle))
+		{
+			return false;
+		}
+		EraseSlot(handle.Index());
+		return true;
+	}
+
+	[[nodiscard]] bool Contains(Handle handle) const
+	{
+		const uint32_t slotIndex = handle.Index();
+		return slotIndex < mSlots.Size() && mSlots[slotIndex].mGeneration == handle.Generation();
+	}
+
+	// Returns nullptr if handle is stale
+	[[nodiscard]] T* Lookup(Handle handle) { return Contains(handle) ? &mValues[mSlots[handle.Index()].mIndex] : nullptr; }
+
+	[[nodiscard]] const T* Lookup(Handle handle) const
+	{
+		return Contains(handle) ? &mValues[mSlots[handle.Index()].mIndex] : nullptr;
+	}
+
+	[[nodiscard]] T& operator[](Handle handle)
+	{
+		ION_ASSERT(Contains(handle), "Stale handle");
+		return mValues[mSlots[handle.Index()].mIndex];
+	}
+
+	[[nodiscard]] const T& operator[](Handle handle) const
+	{
+		ION_ASSERT(Contains(handle), "Stale handle");
+		return mValues[mSlots[handle.Index()].mIndex];
+	}
+
+	// Handle of element in dense array
+	[[nodiscard]] Handle HandleAt(size_t index) const
+	{
+		const uint32_t slotIndex = mValueSlots[index];
+		return Handle(slotIndex, mSlots[slotIndex].mGeneration);
+	}
+
+	// Densely packed elements. Order changes when elements are erased.
+	[[nodiscard]] ArrayView<T, size_t> Values() { return ArrayView<T, size_t>(mValues.Data(), mValues.Size()); }
+
+	[[nodiscard]] ArrayView<const T, size_t> Values() const { return ArrayView<const T, size_t>(mValues.Data(), mValues.Size()); }
+
+	[[nodiscard]] Iterator Begin() { return mValues.Data(); }
+	[[nodiscard]] Iterator End() { return mValues.Data() + mValues.Size(); }
+	[[nodiscard]] ConstIterator Begin() const { return mValues.Data(); }
+	[[nodiscard]] ConstIterator End() const { return mValues.Data() + mValues.Size(); }
+	[[nodiscard]] Iterator begin() { return Begin(); }
+	[[nodiscard]] Iterator end() { return End(); }
+	[[nodiscard]] ConstIterator begin() const { return Begin(); }
+	[[nodiscard]] ConstIterator end() const { return End(); }
+
+	// Calls callback(Handle, T&) for each element
+	template <typename Callback>
+	void ForEach(Callback&& callback)
+	{
+		for (size_t i = 0; i < mValues.Size(); ++i)
+		{
+			callback(HandleAt(i), mValues[i]);
+		}
+	}
+
+	// Erases all elements. All existing handles become stale.
+	void Clear()
+	{
+		while (!mValues.IsEmpty())
+		{
+			EraseSlot(mValueSlots.Back());
+		}
+	}
+
+private:
+	uint32_t AcquireSlot()
+	{
+		if (mFreeHead != EndOfList)
+		{
+			const uint32_t slotIndex = mFreeHead;
+			mFreeHead = mSlots[slotIndex].mIndex;
+			if (mFreeHead == EndOfList)
+			{
+				mFreeTail = EndOfList;
+			}
+			return slotIndex;
+		}
+		ION_ASSERT(mSlots.Size() <= Handle::MaxIndex, "Out of slots");
+		mSlots.Add(Slot{0, 0});
+		return uint32_t(mSlots.Size() - 1);
+	}
+
+	void EraseSlot(uint32_t slotIndex)
+	{
+		Slot& slot = mSlots[slotIndex];
+		const uint32_t index = slot.mIndex;
+		const uint32_t lastIndex = uint32_t(mValues.Size() - 1);
+		if (index != lastIndex)
+		{
+			mValues[index] = std::move(mValues[lastIndex]);
+			mValueSlots[index] = mValueSlots[lastIndex];
+			mSlots[mValueSlots[index]].mIndex = index;
+		}
+		mValues.Pop();
+		mValueSlots.Pop();
+
+		slot.mGeneration++;
+		slot.mIndex = EndOfList;
+		if (slot.mGeneration == RetiredGeneration)
+		{
+			// Reusing slot would make handles of the first generation valid again
+			return;
+		}
+		if (mFreeTail != EndOfList)
+		{
+			mSlots[mFreeTail].mIndex = slotIndex;
+		}
+		else
+		{
+			mFreeHead = slotIndex;
+		}
+		mFreeTail = slotIndex;
+	}
+
+	Vector<T, TAllocator> mValues;
+	Vector<uint32_t, IndexAllocator> mValueSlots;
+	Vector<Slot, SlotAllocator> mSlots;
+	uint32_t mFreeHead = EndOfList;
+	uint32_t mFreeTail = EndOfList;
+};
+}  // namespace ion
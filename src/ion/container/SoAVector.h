@@ -0,0 +1,385 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/container/Algorithm.h>
+#include <ion/container/ArrayView.h>
+
+#include <ion/memory/GlobalAllocator.h>
+
+#include <ion/hw/SIMD.h>
+#include <ion/util/Math.h>
+
+#include <memory>  // std::uninitialized_copy
+#include <tuple>
+#include <utility>
+
+namespace ion
+{
+// Structure of arrays container. Each field is stored in its own array and all arrays share a single allocation.
+//
+// Arrays are aligned to cache lines and capacity is rounded up to batch size, thus field data can be loaded directly to
+// RawBatch also in the last partial batch. Rows are removed by moving the last row in place of the removed row, thus row
+// order is not preserved.
+template <typename TAllocator, typename... Ts>
+class BasicSoAVector
+{
+	static_assert(sizeof...(Ts) > 0, "No fields");
+
+public:
+	static constexpr size_t NumFields = sizeof...(Ts);
+	static constexpr size_t BatchSize = ION_BATCH_SIZE;
+
+	template <size_t Field>
+	using FieldType = std::tuple_element_t<Field, std::tuple<Ts...>>;
+
+	template <bool IsConst>
+	class RowProxy
+	{
+		using Owner = std::conditional_t<IsConst, const BasicSoAVector, BasicSoAVector>;
+
+	public:
+		RowProxy(Owner& owner, size_t index) : mOwner(owner), mIndex(index) {}
+
+		template <size_t Field>
+		auto& Get() const
+		{
+			return mOwner.template Data<Field>()[mIndex];
+		}
+
+		size_t Index() const { return mIndex; }
+
+		// Copies row to tuple
+		std::tuple<Ts...> Load() const { return LoadInternal(std::index_sequence_for<Ts...>()); }
+
+	private:
+		template <size_t... Fields>
+		std::tuple<Ts...> LoadInternal(std::index_sequence<Fields...>) const
+		{
+			return std::tuple<Ts...>(Get<Fields>()...);
+		}
+
+		Owner& mOwner;
+		size_t mIndex;
+	};
+
+	using Row = RowProxy<false>;
+	using ConstRow = RowProxy<true>;
+
+	BasicSoAVector() {}
+
+	template <typename Resource>
+	BasicSoAVector(Resource* resource) : mAllocator(resource)
+	{
+	}
+
+	BasicSoAVector(const BasicSoAVector& other) : mAllocator(other.mAllocator)
+	{
+		Reserve(other.mSize);
+		CopyFields(other, std::index_sequence_for<Ts...>());
+		mSize = other.mSize;
+	}
+
+	BasicSoAVector(BasicSoAVector&& other) noexcept : mAllocator(std::move(other.mAllocator)) { Steal(other); }
+
+	BasicSoAVector& operator=(const BasicSoAVector& other)
+	{
+		if (this != &other)
+		{
+			Clear();
+			Reserve(other.mSize);
+			CopyFields(other, std::index_sequence_for<Ts...>());
+			mSize = other.mSize;
+		}
+		return *this;
+	}
+
+	BasicSoAVector& operator=(BasicSoAVector&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Free();
+			mAllocator = std::move(other.mAllocator);
+			Steal(other);
+		}
+		return *this;
+	}
+
+	~BasicSoAVector() { Free(); }
+
+	[[nodiscard]] size_t Size() const { return mSize; }
+
+	[[nodiscard]] size_t Capacity() const { return mCapacity; }
+
+	[[nodiscard]] bool IsEmpty() const { return mSize == 0; }
+
+	template <size_t Field>
+	[[nodiscard]] FieldType<Field>* Data()
+	{
+		return std::get<Field>(mFields);
+	}
+
+	template <size_t Field>
+	[[nodiscard]] const FieldType<Field>* Data() const
+	{
+		return std::get<Field>(mFields);
+	}
+
+	template <size_t Field>
+	[[nodiscard]] ArrayView<FieldType<Field>, size_t> Span()
+	{
+		return ArrayView<FieldType<Field>, size_t>(Data<Field>(), mSize);
+	}
+
+	template <size_t Field>
+	[[nodiscard]] ArrayView<const FieldType<Field>, size_t> Span() const
+	{
+		return ArrayView<const FieldType<Field>, size_t>(Data<Field>(), mSize);
+	}
+
+	[[nodiscard]] Row operator[](size_t index)
+	{
+		ION_ASSERT(index < mSize, "Out of bounds");
+		return Row(*this, index);
+	}
+
+	[[nodiscard]] ConstRow operator[](size_t index) const
+	{
+		ION_ASSERT(index < mSize, "Out of bounds");
+		return ConstRow(*this, index);
+	}
+
+	[[nodiscard]] Row Back() { return (*this)[mSize - 1]; }
+
+	// Adds row using one argument per field. Returns index of the row.
+	template <typename... Args>
+	size_t Add(Args&&... args)
+	{
+		static_assert(sizeof...(Args) == NumFields, "Expected value for each field");
+		if (mSize == mCapacity)
+		{
+			Grow(mSize + 1);
+		}
+		ConstructRow(mSize, std::index_sequence_for<Ts...>(), std::forward<Args>(args)...);
+		return mSize++;
+	}
+
+	// Adds default constructed row
+	size_t AddDefault()
+	{
+		if (mSize == mCapacity)
+		{
+			Grow(mSize + 1);
+		}
+		ForEachField([&](auto* data) { new (static_cast<void*>(data + mSize)) std::remove_pointer_t<decltype(data)>(); });
+		return mSize++;
+	}
+
+	// Removes row by moving last row in its place
+	void Remove(size_t index)
+	{
+		ION_ASSERT(index < mSize, "Out of bounds");
+		const size_t last = mSize - 1;
+		ForEachField(
+		  [&](auto* data)
+		  {
+			  using T = std::remove_pointer_t<decltype(data)>;
+			  if (index != last)
+			  {
+				  data[index] = std::move(data[last]);
+			  }
+			  data[last].~T();
+		  });
+		mSize = last;
+	}
+
+	void Pop() { Remove(mSize - 1); }
+
+	void Resize(size_t size)
+	{
+		if (size > mCapacity)
+		{
+			Grow(size);
+		}
+		if (size > mSize)
+		{
+			ForEachField(
+			  [&](auto* data)
+			  {
+				  using T = std::remove_pointer_t<decltype(data)>;
+				  for (size_t i = mSize; i < size; ++i)
+				  {
+					  new (static_cast<void*>(data + i)) T();
+				  }
+			  });
+		}
+		else
+		{
+			DestroyRows(size, mSize);
+		}
+		mSize = size;
+	}
+
+	void Reserve(size_t capacity)
+	{
+		if (capacity > mCapacity)
+		{
+			Reallocate(capacity);
+		}
+	}
+
+	void ShrinkToFit()
+	{
+		if (mSize == 0)
+		{
+			Free();
+		}
+		else if (RoundedCapacity(mSize) < mCapacity)
+		{
+			Reallocate(mSize);
+		}
+	}
+
+	void Clear()
+	{
+		DestroyRows(0, mSize);
+		mSize = 0;
+	}
+
+	// Calls callback(T* data) for each field array
+	template <typename Callback>
+	void ForEachField(Callback&& callback)
+	{
+		std::apply([&](auto*... data) { (callback(data), ...); }, mFields);
+	}
+
+private:
+	static constexpr size_t MaxFieldAlignment()
+	{
+		size_t alignment = ION_CONFIG_CACHE_LINE_SIZE;
+		((alignment = ion::Max(alignment, alignof(Ts))), ...);
+		return alignment;
+	}
+
+	static constexpr size_t FieldAlignment = MaxFieldAlignment();
+
+	static constexpr size_t RoundedCapacity(size_t capacity) { return (capacity + BatchSize - 1) / BatchSize * BatchSize; }
+
+	static constexpr size_t ArrayBytes(size_t elementSize, size_t capacity)
+	{
+		return (elementSize * capacity + FieldAlignment - 1) / FieldAlignment * FieldAlignment;
+	}
+
+	static constexpr size_t AllocationSize(size_t capacity) { return (ArrayBytes(sizeof(Ts), capacity) + ...); }
+
+	void Grow(size_t minCapacity) { Reallocate(ion::Max(minCapacity, ion::Max(mCapacity + mCapacity / 2, size_t(BatchSize * 4)))); }
+
+	void Reallocate(size_t capacity)
+	{
+		capacity = RoundedCapacity(capacity);
+		ION_ASSERT(capacity >= mSize, "Cannot drop rows");
+		uint8_t* block = reinterpret_cast<uint8_t*>(mAllocator.AllocateRaw(AllocationSize(capacity), FieldAlignment));
+		std::tuple<Ts*...> fields;
+		uint8_t* pos = block;
+		std::apply(
+		  [&](auto*&... data)
+		  {
+			  ((data = reinterpret_cast<std::remove_reference_t<decltype(data)>>(pos),
+				pos += ArrayBytes(sizeof(*data), capacity)),
+			   ...);
+		  },
+		  fields);
+		RelocateFields(fields, std::index_sequence_for<Ts...>());
+		Deallocate();
+		mBlock = block;
+		mFields = fields;
+		mCapacity = capacity;
+	}
+
+	template <size_t... Fields>
+	void RelocateFields(std::tuple<Ts*...>& target, std::index_sequence<Fields...>)
+	{
+		(ion::Relocate(std::get<Fields>(target), std::get<Fields>(mFields), mSize), ...);
+	}
+
+	template <size_t... Fields>
+	void CopyFields(const BasicSoAVector& other, std::index_sequence<Fields...>)
+	{
+		(std::uninitialized_copy(other.template Data<Fields>(), other.template Data<Fields>() + other.mSize, Data<Fields>()), ...);
+	}
+
+	template <size_t... Fields, typename... Args>
+	void ConstructRow(size_t index, std::index_sequence<Fields...>, Args&&... args)
+	{
+		(new (static_cast<void*>(Data<Fields>() + index)) FieldType<Fields>(std::forward<Args>(args)), ...);
+	}
+
+	void DestroyRows(size_t first, size_t last)
+	{
+		ForEachField(
+		  [&](auto* data)
+		  {
+			  using T = std::remove_pointer_t<decltype(data)>;
+			  if constexpr (!std::is_trivially_destructible_v<T>)
+			  {
+				  for (size_t i = first; i < last; ++i)
+				  {
+					  data[i].~T();
+				  }
+			  }
+		  });
+	}
+
+	void Deallocate()
+	{
+		if (mBlock)
+		{
+			mAllocator.DeallocateRaw(mBlock, AllocationSize(mCapacity), FieldAlignment);
+			mBlock = nullptr;
+		}
+	}
+
+	void Free()
+	{
+		Clear();
+		Deallocate();
+		mFields = std::tuple<Ts*...>();
+		mCapacity = 0;
+	}
+
+	void Steal(BasicSoAVector& other)
+	{
+		mBlock = other.mBlock;
+		mFields = other.mFields;
+		mSize = other.mSize;
+		mCapacity = other.mCapacity;
+		other.mBlock = nullptr;
+		other.mFields = std::tuple<Ts*...>();
+		other.mSize = 0;
+		other.mCapacity = 0;
+	}
+
+	std::tuple<Ts*...> mFields;
+	uint8_t* mBlock = nullptr;
+	size_t mSize = 0;
+	size_t mCapacity = 0;
+	TAllocator mAllocator;
+};
+
+template <typename... Ts>
+using SoAVector = BasicSoAVector<GlobalAllocator<uint8_t>, Ts...>;
+
+}  // namespace ion
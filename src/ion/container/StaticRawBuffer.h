@@ -188,13 +188,11 @@ public:
 	{
 		auto eraseCount = end - start;
 		MoveBackByOffset<TValue>(&mData[start], eraseCount, size - end);
-#if ION_BUILD_DEBUG
 		while (eraseCount > 0)
 		{
-			OnErase(size - eraseCount);
+			Erase(size - eraseCount);
 			eraseCount--;
 		}
-#endif
 	}
 
 	void Clear()
@@ -0,0 +1,739 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/Base.h>
+#include <ion/hw/CPU.h>
+#include <ion/util/Bits.h>
+#include <ion/util/Math.h>
+
+#include <cstddef>
+#include <cstring>
+#include <functional>  // std::equal_to
+#include <utility>
+
+#if ION_CPU_SSE2_ASSUMED
+	#include <emmintrin.h>
+#elif ION_CPU_NEON_ASSUMED
+	#include <arm_neon.h>
+#endif
+
+// Open addressing hash table using groups of control bytes (Swiss table).
+//
+// Each slot has a control byte that is either empty, deleted or 7 bits of the hash of the stored key. Lookup compares control
+// bytes of a whole group with single SIMD instruction and compares keys only for matching control bytes. Elements are stored in
+// place, thus iterators and references are invalidated by rehashing.
+//
+// Groups are aligned to group width and probing moves from group to group. A probe sequence continues past a group only when
+// group is full, thus erased slot can be marked empty instead of deleted when its group still has an empty slot.
+namespace ion
+{
+namespace detail
+{
+constexpr size_t SwissGroupWidth = 16;
+
+enum SwissCtrl : int8_t
+{
+	SwissEmpty = -128,	// 0b10000000
+	SwissDeleted = -2,	// 0b11111110
+	SwissSentinel = -1	// 0b11111111, end of control bytes for iterators
+};
+
+// Bit mask of matching slots in a group. 'Shift' is log2 of bits per slot.
+template <typename T, int Shift>
+class SwissMask
+{
+public:
+	explicit SwissMask(T mask) : mMask(mask) {}
+
+	explicit operator bool() const { return mMask != 0; }
+
+	size_t Lowest() const { return size_t(ion::CountTrailingZeroes(mMask)) >> Shift; }
+
+	void ClearLowest() { mMask &= (mMask - 1); }
+
+private:
+	T mMask;
+};
+
+#if ION_CPU_SSE2_ASSUMED
+class SwissGroup
+{
+public:
+	using Mask = SwissMask<uint32_t, 0>;
+
+	explicit SwissGroup(const int8_t* ctrl) : mCtrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+	Mask Match(int8_t h2) const
+	{
+		return Mask(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), mCtrl))));
+	}
+
+	Mask MatchEmpty() const { return Mask(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(SwissEmpty), mCtrl)))); }
+
+	// Only empty and deleted have the sign bit set inside a group
+	Mask MatchEmptyOrDeleted() const { return Mask(uint32_t(_mm_movemask_epi8(mCtrl))); }
+
+private:
+	__m128i mCtrl;
+};
+#elif ION_CPU_NEON_ASSUMED
+class SwissGroup
+{
+public:
+	// Comparison result is narrowed to 4 bits per slot
+	using Mask = SwissMask<uint64_t, 2>;
+
+	explicit SwissGroup(const int8_t* ctrl) : mCtrl(vld1q_s8(ctrl)) {}
+
+	Mask Match(int8_t h2) const { return ToMask(vceqq_s8(vdupq_n_s8(h2), mCtrl)); }
+
+	Mask MatchEmpty() const { return ToMask(vceqq_s8(vdupq_n_s8(SwissEmpty), mCtrl)); }
+
+	Mask MatchEmptyOrDeleted() const { return ToMask(vcltzq_s8(mCtrl)); }
+
+private:
+	static Mask ToMask(uint8x16_t cmp)
+	{
+		uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+		return Mask(bits & 0x8888888888888888ull);
+	}
+
+	int8x16_t mCtrl;
+};
+#else
+class SwissGroup
+{
+public:
+	using Mask = SwissMask<uint32_t, 0>;
+
+	explicit SwissGroup(const int8_t* ctrl) : mCtrl(ctrl) {}
+
+	Mask Match(int8_t h2) const
+	{
+		uint32_t mask = 0;
+		for (size_t i = 0; i < SwissGroupWidth; ++i)
+		{
+			mask |= uint32_t(mCtrl[i] == h2) << i;
+		}
+		return Mask(mask);
+	}
+
+	Mask MatchEmpty() const { return Match(SwissEmpty); }
+
+	Mask MatchEmptyOrDeleted() const
+	{
+		uint32_t mask = 0;
+		for (size_t i = 0; i < SwissGroupWidth; ++i)
+		{
+			mask |= uint32_t(mCtrl[i] < 0) << i;
+		}
+		return Mask(mask);
+	}
+
+private:
+	const int8_t* mCtrl;
+};
+#endif
+
+// Control bytes of table without allocation. Lookups return immediately when capacity is zero, iterators stop at sentinel.
+inline const int8_t SwissEmptyCtrl[1] = {SwissSentinel};
+
+template <typename TKey>
+struct SwissSetPolicy
+{
+	using key_type = TKey;
+	using value_type = TKey;
+
+	static const key_type& Key(const value_type& value) { return value; }
+};
+
+template <typename TKey, typename TValue>
+struct SwissMapPolicy
+{
+	using key_type = TKey;
+	using value_type = std::pair<const TKey, TValue>;
+
+	static const key_type& Key(const value_type& value) { return value.first; }
+};
+
+template <typename Policy, typename THasher, typename TEqual, typename Allocator>
+class SwissTable
+{
+public:
+	using key_type = typename Policy::key_type;
+	using value_type = typename Policy::value_type;
+	using size_type = size_t;
+	using difference_type = std::ptrdiff_t;
+	using hasher = THasher;
+	using key_equal = TEqual;
+	using allocator_type = Allocator;
+	using reference = value_type&;
+	using const_reference = const value_type&;
+
+	template <bool IsConst>
+	class IteratorBase
+	{
+		friend class SwissTable;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = typename Policy::value_type;
+		using difference_type = std::ptrdiff_t;
+		using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+		using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+
+		IteratorBase() {}
+
+		template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+		IteratorBase(const IteratorBase<OtherConst>& other) : mCtrl(other.mCtrl), mSlot(other.mSlot)
+		{
+		}
+
+		reference operator*() const { return *mSlot; }
+
+		pointer operator->() const { return mSlot; }
+
+		IteratorBase& operator++()
+		{
+			++mCtrl;
+			++mSlot;
+			SkipEmptyOrDeleted();
+			return *this;
+		}
+
+		IteratorBase operator++(int)
+		{
+			IteratorBase tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		friend bool operator==(const IteratorBase& a, const IteratorBase& b) { return a.mCtrl == b.mCtrl; }
+
+		friend bool operator!=(const IteratorBase& a, const IteratorBase& b) { return a.mCtrl != b.mCtrl; }
+
+	private:
+		template <bool>
+		friend class IteratorBase;
+
+		IteratorBase(const int8_t* ctrl, value_type* slot) : mCtrl(ctrl), mSlot(slot) {}
+
+		void SkipEmptyOrDeleted()
+		{
+			while (*mCtrl < SwissSentinel)
+			{
+				++mCtrl;
+				++mSlot;
+			}
+		}
+
+		const int8_t* mCtrl = nullptr;
+		value_type* mSlot = nullptr;
+	};
+
+	// Set elements cannot be modified in place
+	static constexpr bool IsSet = std::is_same_v<typename Policy::value_type, typename Policy::key_type>;
+
+	using iterator = IteratorBase<IsSet>;
+	using const_iterator = IteratorBase<true>;
+
+	SwissTable() {}
+
+	explicit SwissTable(size_t expectedSize, const Allocator& allocator = Allocator()) : mAllocator(allocator)
+	{
+		reserve(expectedSize);
+	}
+
+	explicit SwissTable(const Allocator& allocator) : mAllocator(allocator) {}
+
+	SwissTable(const SwissTable& other) : mHasher(other.mHasher), mEqual(other.mEqual), mAllocator(other.mAllocator)
+	{
+		CopyFrom(other);
+	}
+
+	SwissTable(SwissTable&& other) noexcept
+	  : mHasher(std::move(other.mHasher)), mEqual(std::move(other.mEqual)), mAllocator(std::move(other.mAllocator))
+	{
+		StealFrom(other);
+	}
+
+	SwissTable& operator=(const SwissTable& other)
+	{
+		if (this != &other)
+		{
+			Destroy();
+			mHasher = other.mHasher;
+			mEqual = other.mEqual;
+			CopyFrom(other);
+		}
+		return *this;
+	}
+
+	SwissTable& operator=(SwissTable&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Destroy();
+			mHasher = std::move(other.mHasher);
+			mEqual = std::move(other.mEqual);
+			mAllocator = std::move(other.mAllocator);
+			StealFrom(other);
+		}
+		return *this;
+	}
+
+	~SwissTable() { Destroy(); }
+
+	allocator_type get_allocator() const { return mAllocator; }
+
+	iterator begin()
+	{
+		iterator iter(mCtrl, mSlots);
+		iter.SkipEmptyOrDeleted();
+		return iter;
+	}
+
+	iterator end() { return iterator(mCtrl + mCapacity, mSlots + mCapacity); }
+
+	const_iterator begin() const { return const_cast<SwissTable*>(this)->begin(); }
+
+	const_iterator end() const { return const_cast<SwissTable*>(this)->end(); }
+
+	const_iterator cbegin() const { return begin(); }
+
+	const_iterator cend() const { return end(); }
+
+	bool empty() const { return mSize == 0; }
+
+	size_t size() const { return mSize; }
+
+	size_t capacity() const { return mCapacity; }
+
+	float load_factor() const { return mCapacity ? float(mSize) / float(mCapacity) : 0.0f; }
+
+	float max_load_factor() const { return float(MaxLoadNumerator) / float(MaxLoadDenominator); }
+
+	void clear()
+	{
+		if (mCapacity == 0)
+		{
+			return;
+		}
+		DestroyElements();
+		memset(mCtrl, SwissEmpty, mCapacity);
+		mSize = 0;
+		mGrowthLeft = MaxLoad(mCapacity);
+	}
+
+	void reserve(size_t count)
+	{
+		size_t capacity = CapacityFor(count);
+		if (capacity > mCapacity)
+		{
+			Rehash(capacity);
+		}
+	}
+
+	void rehash(size_t count) { Rehash(CapacityFor(ion::Max(count, mSize))); }
+
+	iterator find(const key_type& key) { return Find(key, Hash(key)); }
+
+	const_iterator find(const key_type& key) const { return const_cast<SwissTable*>(this)->Find(key, Hash(key)); }
+
+	bool contains(const key_type& key) const { return find(key) != end(); }
+
+	size_t count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+	std::pair<iterator, bool> insert(const value_type& value) { return EmplaceKey(Policy::Key(value), value); }
+
+	std::pair<iterator, bool> insert(value_type&& value) { return EmplaceKey(Policy::Key(value), std::move(value)); }
+
+	template <typename P, typename = std::enable_if_t<std::is_constructible_v<value_type, P&&> &&
+													  !std::is_same_v<std::decay_t<P>, value_type>>>
+	std::pair<iterator, bool> insert(P&& value)
+	{
+		if constexpr (IsSet)
+		{
+			return emplace(std::forward<P>(value));
+		}
+		else
+		{
+			return EmplaceKey(value.first, std::forward<P>(value));
+		}
+	}
+
+	template <typename Iterator>
+	void insert(Iterator first, Iterator last)
+	{
+		for (; first != last; ++first)
+		{
+			insert(*first);
+		}
+	}
+
+	template <typename... Args>
+	std::pair<iterator, bool> emplace(Args&&... args)
+	{
+		if constexpr (IsSet && sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, key_type> && ...))
+		{
+			return EmplaceKey(args..., std::forward<Args>(args)...);
+		}
+		else
+		{
+			value_type value(std::forward<Args>(args)...);
+			return EmplaceKey(Policy::Key(value), std::move(value));
+		}
+	}
+
+	iterator erase(const_iterator iter)
+	{
+		EraseAt(size_t(iter.mSlot - mSlots));
+		iterator next(iter.mCtrl, const_cast<value_type*>(iter.mSlot));
+		++next;
+		return next;
+	}
+
+	template <typename Iterator = iterator, typename = std::enable_if_t<!std::is_same_v<Iterator, const_iterator>>>
+	iterator erase(iterator iter)
+	{
+		return erase(const_iterator(iter));
+	}
+
+	size_t erase(const key_type& key)
+	{
+		iterator iter = find(key);
+		if (iter == end())
+		{
+			return 0;
+		}
+		EraseAt(size_t(iter.mSlot - mSlots));
+		return 1;
+	}
+
+protected:
+	// Emplaces value using key that is known before value is constructed
+	template <typename... Args>
+	std::pair<iterator, bool> EmplaceKey(const key_type& key, Args&&... args)
+	{
+		size_t hash = Hash(key);
+		iterator iter = Find(key, hash);
+		if (iter != end())
+		{
+			return {iter, false};
+		}
+		size_t index = PrepareInsert(hash);
+		new (static_cast<void*>(mSlots + index)) value_type(std::forward<Args>(args)...);
+		return {iterator(mCtrl + index, mSlots + index), true};
+	}
+
+private:
+	static constexpr size_t MaxLoadNumerator = 7;
+	static constexpr size_t MaxLoadDenominator = 8;
+
+	static constexpr size_t MaxLoad(size_t capacity) { return capacity / MaxLoadDenominator * MaxLoadNumerator; }
+
+	static size_t CapacityFor(size_t count)
+	{
+		if (count == 0)
+		{
+			return 0;
+		}
+		size_t capacity = SwissGroupWidth;
+		while (MaxLoad(capacity) < count)
+		{
+			capacity *= 2;
+		}
+		return capacity;
+	}
+
+	// Number of value_type units in allocation. Control bytes are stored after slots.
+	static size_t AllocationUnits(size_t capacity)
+	{
+		return capacity + (capacity + 1 + sizeof(value_type) - 1) / sizeof(value_type);
+	}
+
+	size_t Hash(const key_type& key) const
+	{
+		// Hasher might be identity, mix bits so that both group index and control byte are well distributed
+		uint64_t h = uint64_t(mHasher(key)) * 0x9E3779B97F4A7C15ull;
+		return size_t(h ^ (h >> 32));
+	}
+
+	static int8_t H2(size_t hash) { return int8_t(hash & 0x7F); }
+
+	static size_t H1(size_t hash) { return hash >> 7; }
+
+	iterator Find(const key_type& key, size_t hash)
+	{
+		if (mCapacity == 0)
+		{
+			return end();
+		}
+		const size_t groupMask = mCapacity / SwissGroupWidth - 1;
+		const int8_t h2 = H2(hash);
+		size_t group = H1(hash) & groupMask;
+		for (size_t step = 1;; ++step)
+		{
+			const size_t base = group * SwissGroupWidth;
+			SwissGroup g(mCtrl + base);
+			for (auto mask = g.Match(h2); mask; mask.ClearLowest())
+			{
+				const size_t index = base + mask.Lowest();
+				if ION_LIKELY (mEqual(Policy::Key(mSlots[index]), key))
+				{
+					return iterator(mCtrl + index, mSlots + index);
+				}
+			}
+			if ION_LIKELY (g.MatchEmpty())
+			{
+				return end();
+			}
+			ION_ASSERT(step <= groupMask, "Probe sequence exhausted");
+			group = (group + step) & groupMask;
+		}
+	}
+
+	size_t FindFirstNonFull(size_t hash) const
+	{
+		const size_t groupMask = mCapacity / SwissGroupWidth - 1;
+		size_t group = H1(hash) & groupMask;
+		for (size_t step = 1;; ++step)
+		{
+			const size_t base = group * SwissGroupWidth;
+			auto mask = SwissGroup(mCtrl + base).MatchEmptyOrDeleted();
+			if ION_LIKELY (mask)
+			{
+				return base + mask.Lowest();
+			}
+			ION_ASSERT(step <= groupMask, "Probe sequence exhausted");
+			group = (group + step) & groupMask;
+		}
+	}
+
+	size_t PrepareInsert(size_t hash)
+	{
+		size_t index;
+		if (mCapacity == 0)
+		{
+			Rehash(SwissGroupWidth);
+			index = FindFirstNonFull(hash);
+		}
+		else
+		{
+			index = FindFirstNonFull(hash);
+			if ION_UNLIKELY (mGrowthLeft == 0 && mCtrl[index] == SwissEmpty)
+			{
+				// Drop deleted slots when at most half of load is in use, otherwise grow
+				Rehash(mSize * 2 <= MaxLoad(mCapacity) ? mCapacity : mCapacity * 2);
+				index = FindFirstNonFull(hash);
+			}
+		}
+		mGrowthLeft -= (mCtrl[index] == SwissEmpty) ? 1 : 0;
+		mCtrl[index] = H2(hash);
+		++mSize;
+		return index;
+	}
+
+	void EraseAt(size_t index)
+	{
+		ION_ASSERT(mCtrl[index] >= 0, "Invalid slot");
+		mSlots[index].~value_type();
+		--mSize;
+		// Probe sequences do not pass a group having an empty slot, thus no tombstone is needed
+		const size_t base = index & ~(SwissGroupWidth - 1);
+		if (SwissGroup(mCtrl + base).MatchEmpty())
+		{
+			mCtrl[index] = SwissEmpty;
+			++mGrowthLeft;
+		}
+		else
+		{
+			mCtrl[index] = SwissDeleted;
+		}
+	}
+
+	void Allocate(size_t capacity)
+	{
+		ION_ASSERT(capacity >= SwissGroupWidth && ion::IsPowerOfTwo(capacity), "Invalid capacity");
+		mSlots = mAllocator.allocate(AllocationUnits(capacity));
+		mCtrl = reinterpret_cast<int8_t*>(mSlots + capacity);
+		memset(mCtrl, SwissEmpty, capacity);
+		mCtrl[capacity] = SwissSentinel;
+		mCapacity = capacity;
+		mGrowthLeft = MaxLoad(capacity);
+	}
+
+	void Rehash(size_t capacity)
+	{
+		value_type* oldSlots = mSlots;
+		int8_t* oldCtrl = mCtrl;
+		size_t oldCapacity = mCapacity;
+		if (capacity == 0)
+		{
+			ION_ASSERT(mSize == 0, "Cannot rehash to zero capacity");
+			Destroy();
+			return;
+		}
+		Allocate(capacity);
+		for (size_t i = 0; i < oldCapacity; ++i)
+		{
+			if (oldCtrl[i] >= 0)
+			{
+				size_t hash = Hash(Policy::Key(oldSlots[i]));
+				size_t index = FindFirstNonFull(hash);
+				mCtrl[index] = H2(hash);
+				Relocate(mSlots + index, oldSlots + i);
+			}
+		}
+		mGrowthLeft -= mSize;
+		if (oldCapacity)
+		{
+			mAllocator.deallocate(oldSlots, AllocationUnits(oldCapacity));
+		}
+	}
+
+	static void Relocate(value_type* dst, value_type* src)
+	{
+		if constexpr (IsSet)
+		{
+			new (static_cast<void*>(dst)) value_type(std::move(*src));
+		}
+		else
+		{
+			// Key is const only for the user, element is destroyed right after moving it
+			new (static_cast<void*>(dst))
+			  value_type(std::move(const_cast<typename Policy::key_type&>(src->first)), std::move(src->second));
+		}
+		src->~value_type();
+	}
+
+	void CopyFrom(const SwissTable& other)
+	{
+		if (other.mCapacity == 0)
+		{
+			return;
+		}
+		Allocate(other.mCapacity);
+		memcpy(mCtrl, other.mCtrl, mCapacity);
+		for (size_t i = 0; i < mCapacity; ++i)
+		{
+			if (mCtrl[i] >= 0)
+			{
+				new (static_cast<void*>(mSlots + i)) value_type(other.mSlots[i]);
+			}
+		}
+		mSize = other.mSize;
+		mGrowthLeft = other.mGrowthLeft;
+	}
+
+	void StealFrom(SwissTable& other)
+	{
+		mCtrl = other.mCtrl;
+		mSlots = other.mSlots;
+		mCapacity = other.mCapacity;
+		mSize = other.mSize;
+		mGrowthLeft = other.mGrowthLeft;
+		other.mCtrl = const_cast<int8_t*>(SwissEmptyCtrl);
+		other.mSlots = nullptr;
+		other.mCapacity = 0;
+		other.mSize = 0;
+		other.mGrowthLeft = 0;
+	}
+
+	void DestroyElements()
+	{
+		if constexpr (!std::is_trivially_destructible_v<value_type>)
+		{
+			for (size_t i = 0; i < mCapacity; ++i)
+			{
+				if (mCtrl[i] >= 0)
+				{
+					mSlots[i].~value_type();
+				}
+			}
+		}
+	}
+
+	void Destroy()
+	{
+		if (mCapacity)
+		{
+			DestroyElements();
+			mAllocator.deallocate(mSlots, AllocationUnits(mCapacity));
+		}
+		mCtrl = const_cast<int8_t*>(SwissEmptyCtrl);
+		mSlots = nullptr;
+		mCapacity = 0;
+		mSize = 0;
+		mGrowthLeft = 0;
+	}
+
+	int8_t* mCtrl = const_cast<int8_t*>(SwissEmptyCtrl);
+	value_type* mSlots = nullptr;
+	size_t mCapacity = 0;
+	size_t mSize = 0;
+	size_t mGrowthLeft = 0;
+	THasher mHasher;
+	TEqual mEqual;
+	Allocator mAllocator;
+};
+}  // namespace detail
+
+template <typename TKey, typename TValue, typename THasher, typename TEqual = std::equal_to<TKey>,
+		  typename Allocator = std::allocator<std::pair<const TKey, TValue>>>
+class SwissMap : public detail::SwissTable<detail::SwissMapPolicy<TKey, TValue>, THasher, TEqual, Allocator>
+{
+	using Super = detail::SwissTable<detail::SwissMapPolicy<TKey, TValue>, THasher, TEqual, Allocator>;
+
+public:
+	using mapped_type = TValue;
+	using Super::Super;
+
+	template <typename... Args>
+	std::pair<typename Super::iterator, bool> try_emplace(const TKey& key, Args&&... args)
+	{
+		return Super::EmplaceKey(key, std::piecewise_construct, std::forward_as_tuple(key),
+								 std::forward_as_tuple(std::forward<Args>(args)...));
+	}
+
+	TValue& operator[](const TKey& key) { return try_emplace(key).first->second; }
+
+	TValue& at(const TKey& key)
+	{
+		auto iter = Super::find(key);
+		ION_ASSERT(iter != Super::end(), "Key not found");
+		return iter->second;
+	}
+
+	const TValue& at(const TKey& key) const
+	{
+		auto iter = Super::find(key);
+		ION_ASSERT(iter != Super::end(), "Key not found");
+		return iter->second;
+	}
+};
+
+template <typename TKey, typename THasher, typename TEqual = std::equal_to<TKey>, typename Allocator = std::allocator<TKey>>
+class SwissSet : public detail::SwissTable<detail::SwissSetPolicy<TKey>, THasher, TEqual, Allocator>
+{
+	using Super = detail::SwissTable<detail::SwissSetPolicy<TKey>, THasher, TEqual, Allocator>;
+
+public:
+	using Super::Super;
+};
+
+}  // namespace ion
@@ -23,6 +23,8 @@
 #elif ION_EXTERNAL_UNORDERED_MAP == 1
 	#define TSL_HH_NO_EXCEPTIONS
 	#include <hopscotch_map/hopscotch_map.h>
+#else
+	#include <ion/container/SwissTable.h>
 #endif
 
 namespace ion
@@ -39,8 +41,10 @@ class UnorderedMap
 {
 #if ION_EXTERNAL_UNORDERED_MAP == 0
 	using UnorderedMapContainer = std::unordered_map<TKey, TValue, THasher, std::equal_to<TKey>, Allocator>;
-#else
+#elif ION_EXTERNAL_UNORDERED_MAP == 1
 	using UnorderedMapContainer = tsl::hopscotch_map<TKey, TValue, THasher, std::equal_to<TKey>, Allocator>;
+#else
+	using UnorderedMapContainer = ion::SwissMap<TKey, TValue, THasher, std::equal_to<TKey>, Allocator>;
 #endif
 public:
 	using KeyType = TKey;
@@ -18,9 +18,11 @@
 #include <ion/Base.h>
 #include <ion/util/Hasher.h>
 #include <ion/memory/GlobalAllocator.h>
-#include <hopscotch_map/hopscotch_set.h>
-
-#include <unordered_set>
+#if ION_EXTERNAL_UNORDERED_MAP == 2
+	#include <ion/container/SwissTable.h>
+#else
+	#include <unordered_set>
+#endif
 
 namespace ion
 {
@@ -28,7 +30,11 @@ template <class TKey, class TAllocator = ion::GlobalAllocator<TKey>, class THash
 class UnorderedSet
 {
 public:
+#if ION_EXTERNAL_UNORDERED_MAP == 2
+	using SetImplementation = ion::SwissSet<TKey, THasher, std::equal_to<TKey>, TAllocator>;
+#else
 	using SetImplementation = std::unordered_set<TKey, THasher, std::equal_to<TKey>, TAllocator>;
+#endif
 
 	explicit UnorderedSet() : mImpl() {}
 
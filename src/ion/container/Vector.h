@@ -299,4 +299,11 @@ struct IsArray<ion::Vector<Type, Allocator, CountType, SmallBufferSize, TinyBuff
 {
 };
 
+template <typename Type, typename Allocator, typename CountType, size_t SmallBufferSize, size_t TinyBufferSize>
+struct IsTriviallyRelocatable<ion::Vector<Type, Allocator, CountType, SmallBufferSize, TinyBufferSize>>
+  : std::bool_constant<IsTriviallyRelocatableV<Allocator> &&
+					   IsTriviallyRelocatableV<ion::ArenaVector<Type, SmallBufferSize, CountType, TinyBufferSize>>>
+{
+};
+
 }  // namespace ion
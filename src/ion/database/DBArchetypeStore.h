@@ -0,0 +1,856 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <ion/container/Algorithm.h>
+#include <ion/container/FlatMap.h>
+#include <ion/container/SlotMap.h>
+#include <ion/container/Vector.h>
+#include <ion/database/DBComponentConfig.h>
+#include <ion/jobs/JobScheduler.h>
+#include <ion/memory/GlobalAllocator.h>
+#include <ion/util/BitIdPool.h>
+#include <ion/util/Bits.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>  // std::allocator_traits
+
+#ifndef ION_ARCHETYPE_MAX_COMPONENT_TYPES
+	#define ION_ARCHETYPE_MAX_COMPONENT_TYPES 128
+#endif
+
+#ifndef ION_ARCHETYPE_CHUNK_SIZE
+	#define ION_ARCHETYPE_CHUNK_SIZE (16 * 1024)
+#endif
+
+namespace ion
+{
+using Entity = SlotHandle64;
+
+// Runtime information of component type needed for moving components between archetypes
+struct ComponentTypeInfo
+{
+	uint32_t mId;
+	uint32_t mSize;
+	uint32_t mAlignment;
+	void (*mRelocate)(void* destination, void* source, size_t count);	 // nullptr when memcpy can be used
+	void (*mDestroy)(void* data, size_t count);							 // nullptr when trivially destructible
+};
+
+namespace detail
+{
+inline std::atomic<uint32_t> gNextComponentTypeId = 0;
+inline const ComponentTypeInfo* gComponentTypeInfos[ION_ARCHETYPE_MAX_COMPONENT_TYPES] = {};
+
+template <typename T>
+ComponentTypeInfo MakeComponentTypeInfo()
+{
+	ComponentTypeInfo info;
+	info.mId = gNextComponentTypeId++;
+	ION_ASSERT_FMT_IMMEDIATE(info.mId < ION_ARCHETYPE_MAX_COMPONENT_TYPES,
+							 "Too many component types, increase ION_ARCHETYPE_MAX_COMPONENT_TYPES");
+	info.mSize = uint32_t(sizeof(T));
+	info.mAlignment = uint32_t(alignof(T));
+	if constexpr (IsTriviallyRelocatableV<T>)
+	{
+		info.mRelocate = nullptr;
+	}
+	else
+	{
+		info.mRelocate = [](void* destination, void* source, size_t count)
+		{ ion::Relocate(static_cast<T*>(destination), static_cast<T*>(source), count); };
+	}
+	if constexpr (std::is_trivially_destructible_v<T>)
+	{
+		info.mDestroy = nullptr;
+	}
+	else
+	{
+		info.mDestroy = [](void* data, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				static_cast<T*>(data)[i].~T();
+			}
+		};
+	}
+	return info;
+}
+}  // namespace detail
+
+// Type info of component. Type ids are assigned on first use, thus they are only valid within a process.
+template <typename T>
+[[nodiscard]] inline const ComponentTypeInfo& GetComponentTypeInfo()
+{
+	static_assert(!std::is_const_v<T> && !std::is_reference_v<T>, "Use plain component type");
+	static const ComponentTypeInfo info = detail::MakeComponentTypeInfo<T>();
+	[[maybe_unused]] static const ComponentTypeInfo* registered = detail::gComponentTypeInfos[info.mId] = &info;
+	return info;
+}
+
+template <typename T>
+[[nodiscard]] inline uint32_t GetComponentTypeId()
+{
+	return GetComponentTypeInfo<T>().mId;
+}
+
+// Type info of component type id that has been used
+[[nodiscard]] inline const ComponentTypeInfo& GetComponentTypeInfo(uint32_t typeId)
+{
+	ION_ASSERT(typeId < ION_ARCHETYPE_MAX_COMPONENT_TYPES && detail::gComponentTypeInfos[typeId], "Unknown component type");
+	return *detail::gComponentTypeInfos[typeId];
+}
+
+// Set of component types
+class ComponentMask
+{
+	static constexpr size_t NumWords = (ION_ARCHETYPE_MAX_COMPONENT_TYPES + 63) / 64;
+
+public:
+	template <typename... Ts>
+	[[nodiscard]] static ComponentMask Of()
+	{
+		ComponentMask mask;
+		(mask.Set(GetComponentTypeId<std::remove_const_t<Ts>>()), ...);
+		return mask;
+	}
+
+	void Set(uint32_t typeId) { mWords[typeId >> 6] |= uint64_t(1) << (typeId & 63); }
+
+	void Reset(uint32_t typeId) { mWords[typeId >> 6] &= ~(uint64_t(1) << (typeId & 63)); }
+
+	[[nodiscard]] bool Test(uint32_t typeId) const { return (mWords[typeId >> 6] & (uint64_t(1) << (typeId & 63))) != 0; }
+
+	// True if all types of 'other' are in this mask
+	[[nodiscard]] bool Contains(const ComponentMask& other) const
+	{
+		for (size_t i = 0; i < NumWords; ++i)
+		{
+			if ((mWords[i] & other.mWords[i]) != other.mWords[i])
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// True if masks have common types
+	[[nodiscard]] bool Intersects(const ComponentMask& other) const
+	{
+		for (size_t i = 0; i < NumWords; ++i)
+		{
+			if ((mWords[i] & other.mWords[i]) != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	[[nodiscard]] bool IsEmpty() const
+	{
+		for (size_t i = 0; i < NumWords; ++i)
+		{
+			if (mWords[i] != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Calls callback(uint32_t typeId) in ascending order of type ids
+	template <typename Callback>
+	void ForEach(Callback&& callback) const
+	{
+		for (size_t i = 0; i < NumWords; ++i)
+		{
+			ion::ForEachEnabledBit(mWords[i], [&](int bit) { callback(uint32_t(i * 64 + size_t(bit))); });
+		}
+	}
+
+	ComponentMask& operator|=(const ComponentMask& other)
+	{
+		for (size_t i = 0; i < NumWords; ++i)
+		{
+			mWords[i] |= other.mWords[i];
+		}
+		return *this;
+	}
+
+	bool operator==(const ComponentMask& other) const { return std::memcmp(mWords, other.mWords, sizeof(mWords)) == 0; }
+	bool operator!=(const ComponentMask& other) const { return !(*this == other); }
+
+private:
+	uint64_t mWords[NumWords] = {};
+};
+
+// Entity storage grouped by archetypes. Archetype is the set of component types of an entity.
+//
+// Entities of an archetype are stored in fixed size chunks. Chunk has an array of entity handles followed by an array for
+// each component type, thus components of an entity are in separate arrays (SoA) and iterating a few components of many
+// entities streams only the needed memory. Entities are kept densely packed: removing an entity moves the last entity of
+// the archetype to its place, thus only the last chunk of an archetype can be partially filled.
+//
+// Adding or removing a component moves the entity to another archetype. Archetype transitions are cached per archetype, so
+// finding the target archetype is a binary search over small array. Queries visit only archetypes that have all queried
+// components. Pointers to components are invalidated by entity creation, destruction and component add and remove.
+//
+// Each chunk has a change tick per component array, which is set to the current tick when the array is accessed as mutable
+// or when entities are moved to the chunk. ForEachChangedChunk() visits only chunks changed after a given tick, thus passes
+// that process changes, e.g. replication, do not need to scan all entities. Changes are tracked per chunk, so callback
+// must filter entities if it needs exact changes.
+template <typename TAllocator = ion::GlobalAllocator<uint8_t>>
+class ArchetypeStore
+{
+	using ByteAllocator = typename std::allocator_traits<TAllocator>::template rebind_alloc<uint8_t>;
+
+	template <typename T>
+	using VectorOf = ion::Vector<T, typename std::allocator_traits<TAllocator>::template rebind_alloc<T>>;
+
+public:
+	static constexpr size_t ChunkSize = ION_ARCHETYPE_CHUNK_SIZE;
+	static constexpr size_t ChunkAlignment = ION_CONFIG_CACHE_LINE_SIZE;
+	static constexpr uint32_t InvalidArchetype = ~uint32_t(0);
+
+	ArchetypeStore() { Init(); }
+
+	template <typename Resource>
+	ArchetypeStore(Resource* resource)
+	  : mArchetypes(resource), mRecords(resource), mEntityIds(resource), mAllocator(resource), mEmptyArchetype(resource)
+	{
+		Init();
+	}
+
+	ArchetypeStore(const ArchetypeStore&) = delete;
+	ArchetypeStore& operator=(const ArchetypeStore&) = delete;
+
+	~ArchetypeStore()
+	{
+		Clear();
+	}
+
+	// Creates entity without components
+	[[nodiscard]] Entity Create()
+	{
+		const uint32_t index = mEntityIds.Reserve();
+		if (index == mRecords.Size())
+		{
+			mRecords.Add(Record{InvalidArchetype, 0, 0, 0});
+		}
+		Record& record = mRecords[index];
+		const Entity entity(index, record.mGeneration);
+		AddRow(0, entity);
+		return entity;
+	}
+
+	void Destroy(Entity entity)
+	{
+		ION_ASSERT(IsAlive(entity), "Invalid entity");
+		const uint32_t index = entity.Index();
+		Record& record = mRecords[index];
+		Archetype& archetype = mArchetypes[record.mArchetype];
+		Chunk& chunk = archetype.mChunks[record.mChunk];
+		for (size_t i = 0; i < archetype.mColumns.Size(); ++i)
+		{
+			const Column& column = archetype.mColumns[i];
+			if (column.mInfo->mDestroy)
+			{
+				column.mInfo->mDestroy(ColumnData(chunk, column, record.mRow), 1);
+			}
+		}
+		RemoveRow(record.mArchetype, record.mChunk, record.mRow);
+		record.mArchetype = InvalidArchetype;
+		record.mGeneration = (record.mGeneration + 1) & uint32_t(Entity::GenerationMask);
+		mEntityIds.Free(index);
+	}
+
+	// Destroys all entities. Archetypes and their transitions are kept.
+	void Clear()
+	{
+		for (size_t a = 0; a < mArchetypes.Size(); ++a)
+		{
+			Archetype& archetype = mArchetypes[a];
+			for (size_t c = 0; c < archetype.mChunks.Size(); ++c)
+			{
+				Chunk& chunk = archetype.mChunks[c];
+				for (size_t i = 0; i < archetype.mColumns.Size(); ++i)
+				{
+					const Column& column = archetype.mColumns[i];
+					if (column.mInfo->mDestroy)
+					{
+						column.mInfo->mDestroy(ColumnData(chunk, column, 0), chunk.mCount);
+					}
+				}
+				mAllocator.DeallocateRaw(chunk.mData, ChunkSize, ChunkAlignment);
+			}
+			archetype.mChunks.Clear();
+			archetype.mSize = 0;
+		}
+		mEntityIds.ForEachUsed(
+		  [&](uint32_t index)
+		  {
+			  Record& record = mRecords[index];
+			  record.mArchetype = InvalidArchetype;
+			  record.mGeneration = (record.mGeneration + 1) & uint32_t(Entity::GenerationMask);
+		  });
+		mEntityIds.Reset();
+	}
+
+	[[nodiscard]] bool IsAlive(Entity entity) const
+	{
+		const uint32_t index = entity.Index();
+		return index < mRecords.Size() && mRecords[index].mArchetype != InvalidArchetype &&
+			   mRecords[index].mGeneration == entity.Generation();
+	}
+
+	[[nodiscard]] size_t Size() const { return mEntityIds.Size(); }
+
+	[[nodiscard]] size_t NumArchetypes() const { return mArchetypes.Size(); }
+
+	// Changes are stamped with current tick. Ticks wrap around, thus ticks compared must be less than 2^31 ticks apart.
+	[[nodiscard]] uint32_t Tick() const { return mTick; }
+
+	void AdvanceTick() { mTick++; }
+
+	// True if tick 'a' is after tick 'b'
+	[[nodiscard]] static constexpr bool IsNewer(uint32_t a, uint32_t b) { return int32_t(a - b) > 0; }
+
+	// True if chunk of entity has changes to component T after the tick
+	template <typename T>
+	[[nodiscard]] bool HasChangedSince(Entity entity, uint32_t tick) const
+	{
+		ION_ASSERT(IsAlive(entity), "Invalid entity");
+		const Record& record = mRecords[entity.Index()];
+		const Archetype& archetype = mArchetypes[record.mArchetype];
+		const size_t column = archetype.ColumnIndex(GetComponentTypeId<T>());
+		return IsNewer(ChangeTicks(archetype, archetype.mChunks[record.mChunk])[column], tick);
+	}
+
+	// Adds component to entity and moves entity to archetype that has the component
+	template <typename T, typename... Args>
+	T& Add(Entity entity, Args&&... args)
+	{
+		ION_ASSERT(IsAlive(entity), "Invalid entity");
+		const uint32_t typeId = GetComponentTypeId<T>();
+		Record& record = mRecords[entity.Index()];
+		ION_ASSERT(!mArchetypes[record.mArchetype].mMask.Test(typeId), "Component already added");
+		const uint32_t target = AddTransition(record.mArchetype, typeId);
+		MoveEntity(record, target);
+		T* component = static_cast<T*>(ComponentData(record, typeId));
+		new (static_cast<void*>(component)) T(std::forward<Args>(args)...);
+		return *component;
+	}
+
+	// Removes component from entity and moves entity to archetype that does not have the component
+	template <typename T>
+	void Remove(Entity entity)
+	{
+		ION_ASSERT(IsAlive(entity), "Invalid entity");
+		const uint32_t typeId = GetComponentTypeId<T>();
+		Record& record = mRecords[entity.Index()];
+		ION_ASSERT(mArchetypes[record.mArchetype].mMask.Test(typeId), "Component not found");
+		const uint32_t target = RemoveTransition(record.mArchetype, typeId);
+		MoveEntity(record, target);
+	}
+
+	template <typename T>
+	[[nodiscard]] bool Has(Entity entity) const
+	{
+		ION_ASSERT(IsAlive(entity), "Invalid entity");
+		return mArchetypes[mRecords[entity.Index()].mArchetype].mMask.Test(GetComponentTypeId<T>());
+	}
+
+	// Returns nullptr if entity does not have the component. Component is marked changed.
+	template <typename T>
+	[[nodiscard]] T* Get(Entity entity)
+	{
+		ION_ASSERT(IsAlive(entity), "Invalid entity");
+		const Record& record = mRecords[entity.Index()];
+		const uint32_t typeId = GetComponentTypeId<T>();
+		Archetype& archetype = mArchetypes[record.mArchetype];
+		if (!archetype.mMask.Test(typeId))
+		{
+			return nullptr;
+		}
+		const size_t column = archetype.ColumnIndex(typeId);
+		const Chunk& chunk = archetype.mChunks[record.mChunk];
+		ChangeTicks(archetype, chunk)[column] = mTick;
+		return static_cast<T*>(ColumnData(chunk, archetype.mColumns[column], record.mRow));
+	}
+
+	template <typename T>
+	[[nodiscard]] const T* Get(Entity entity) const
+	{
+		ION_ASSERT(IsAlive(entity), "Invalid entity");
+		return static_cast<const T*>(ComponentData(mRecords[entity.Index()], GetComponentTypeId<T>()));
+	}
+
+	// Calls callback(size_t count, const Entity* entities, Ts*... components) for each chunk that has all components Ts.
+	// Const component types are for read-only access, other components are marked changed.
+	template <typename... Ts, typename Callback>
+	void ForEachChunk(Callback&& callback)
+	{
+		const ComponentMask mask = ComponentMask::Of<Ts...>();
+		for (size_t a = 0; a < mArchetypes.Size(); ++a)
+		{
+			Archetype& archetype = mArchetypes[a];
+			if (archetype.mSize == 0 || !archetype.mMask.Contains(mask))
+			{
+				continue;
+			}
+			const QueryColumns<sizeof...(Ts)> query = MakeQuery<Ts...>(archetype);
+			for (size_t c = 0; c < archetype.mChunks.Size(); ++c)
+			{
+				MarkWritten<Ts...>(archetype, archetype.mChunks[c], query);
+				CallWithChunk<Ts...>(archetype.mChunks[c], query.mOffsets, callback, std::index_sequence_for<Ts...>());
+			}
+		}
+	}
+
+	// As ForEachChunk, but visits only chunks that have changes to any of components Ts after 'sinceTick'
+	template <typename... Ts, typename Callback>
+	void ForEachChangedChunk(uint32_t sinceTick, Callback&& callback)
+	{
+		const ComponentMask mask = ComponentMask::Of<Ts...>();
+		for (size_t a = 0; a < mArchetypes.Size(); ++a)
+		{
+			Archetype& archetype = mArchetypes[a];
+			if (archetype.mSize == 0 || !archetype.mMask.Contains(mask))
+			{
+				continue;
+			}
+			const QueryColumns<sizeof...(Ts)> query = MakeQuery<Ts...>(archetype);
+			for (size_t c = 0; c < archetype.mChunks.Size(); ++c)
+			{
+				const uint32_t* ticks = ChangeTicks(archetype, archetype.mChunks[c]);
+				bool isChanged = false;
+				for (size_t i = 0; i < sizeof...(Ts); ++i)
+				{
+					isChanged |= IsNewer(ticks[query.mColumns[i]], sinceTick);
+				}
+				if (isChanged)
+				{
+					MarkWritten<Ts...>(archetype, archetype.mChunks[c], query);
+					CallWithChunk<Ts...>(archetype.mChunks[c], query.mOffsets, callback, std::index_sequence_for<Ts...>());
+				}
+			}
+		}
+	}
+
+	// Calls callback(Ts&... components) for each entity that has all components Ts
+	template <typename... Ts, typename Callback>
+	void ForEach(Callback&& callback)
+	{
+		ForEachChunk<Ts...>(
+		  [&](size_t count, const Entity*, Ts*... components)
+		  {
+			  for (size_t i = 0; i < count; ++i)
+			  {
+				  callback(components[i]...);
+			  }
+		  });
+	}
+
+	// As ForEachChunk, but chunks are processed in parallel. Callback must not create or destroy entities nor add or remove
+	// components.
+	template <typename... Ts, typename Callback>
+	void ParallelForEachChunk(ion::JobScheduler& js, Callback&& callback)
+	{
+		struct QueryChunk
+		{
+			Chunk* mChunk;
+			QueryColumns<sizeof...(Ts)> mQuery;
+		};
+		ion::SmallVector<QueryChunk, 64> chunks;
+		const ComponentMask mask = ComponentMask::Of<Ts...>();
+		for (size_t a = 0; a < mArchetypes.Size(); ++a)
+		{
+			Archetype& archetype = mArchetypes[a];
+			if (archetype.mSize == 0 || !archetype.mMask.Contains(mask))
+			{
+				continue;
+			}
+			QueryChunk query{nullptr, MakeQuery<Ts...>(archetype)};
+			for (size_t c = 0; c < archetype.mChunks.Size(); ++c)
+			{
+				query.mChunk = &archetype.mChunks[c];
+				MarkWritten<Ts...>(archetype, *query.mChunk, query.mQuery);
+				chunks.Add(query);
+			}
+		}
+		if (chunks.IsEmpty())
+		{
+			return;
+		}
+		js.ParallelFor(chunks.Begin(), chunks.End(), ion::JobScheduler::DefaultPartitionSize(chunks.Size()), 1u,
+					   [&](QueryChunk& query)
+					   { CallWithChunk<Ts...>(*query.mChunk, query.mQuery.mOffsets, callback, std::index_sequence_for<Ts...>()); });
+	}
+
+	// As ForEach, but chunks are processed in parallel
+	template <typename... Ts, typename Callback>
+	void ParallelForEach(ion::JobScheduler& js, Callback&& callback)
+	{
+		ParallelForEachChunk<Ts...>(js,
+									[&](size_t count, const Entity*, Ts*... components)
+									{
+										for (size_t i = 0; i < count; ++i)
+										{
+											callback(components[i]...);
+										}
+									});
+	}
+
+	// Number of entities that have all components Ts
+	template <typename... Ts>
+	[[nodiscard]] size_t Count() const
+	{
+		const ComponentMask mask = ComponentMask::Of<Ts...>();
+		size_t count = 0;
+		for (size_t a = 0; a < mArchetypes.Size(); ++a)
+		{
+			if (mArchetypes[a].mMask.Contains(mask))
+			{
+				count += mArchetypes[a].mSize;
+			}
+		}
+		return count;
+	}
+
+private:
+	struct Record
+	{
+		uint32_t mArchetype;
+		uint32_t mChunk;
+		uint32_t mRow;
+		uint32_t mGeneration;
+	};
+
+	struct Column
+	{
+		const ComponentTypeInfo* mInfo;
+		uint32_t mOffset;  // Offset of component array in chunk
+	};
+
+	struct Chunk
+	{
+		uint8_t* mData;
+		uint32_t mCount;
+	};
+
+	struct Archetype
+	{
+		template <typename Resource>
+		Archetype(Resource* resource) : mColumns(resource), mChunks(resource), mAddTransitions(resource), mRemoveTransitions(resource)
+		{
+		}
+
+		Archetype() {}
+
+		// Columns are sorted by type id
+		size_t ColumnIndex(uint32_t typeId) const
+		{
+			size_t first = 0;
+			size_t count = mColumns.Size();
+			while (count > 0)
+			{
+				const size_t step = count / 2;
+				if (mColumns[first + step].mInfo->mId < typeId)
+				{
+					first += step + 1;
+					count -= step + 1;
+				}
+				else
+				{
+					count = step;
+				}
+			}
+			ION_ASSERT(first < mColumns.Size() && mColumns[first].mInfo->mId == typeId, "Component not found");
+			return first;
+		}
+
+		ComponentMask mMask;
+		VectorOf<Column> mColumns;
+		VectorOf<Chunk> mChunks;
+		ion::FlatMap<uint32_t, uint32_t, std::less<uint32_t>, typename std::allocator_traits<TAllocator>::template rebind_alloc<uint32_t>>
+		  mAddTransitions;
+		ion::FlatMap<uint32_t, uint32_t, std::less<uint32_t>, typename std::allocator_traits<TAllocator>::template rebind_alloc<uint32_t>>
+		  mRemoveTransitions;
+		size_t mSize = 0;
+		uint32_t mCapacity = 0;		// Entities per chunk
+		uint32_t mTicksOffset = 0;	// Offset of change tick array in chunk
+	};
+
+	// Offsets and column indices of queried components in archetype
+	template <size_t N>
+	struct QueryColumns
+	{
+		uint32_t mOffsets[N + 1];
+		uint32_t mColumns[N + 1];
+	};
+
+	void Init() { FindOrCreateArchetype(ComponentMask()); }
+
+	template <typename... Ts>
+	static QueryColumns<sizeof...(Ts)> MakeQuery(const Archetype& archetype)
+	{
+		QueryColumns<sizeof...(Ts)> query{{}, {uint32_t(archetype.ColumnIndex(GetComponentTypeId<std::remove_const_t<Ts>>()))..., 0}};
+		for (size_t i = 0; i < sizeof...(Ts); ++i)
+		{
+			query.mOffsets[i] = archetype.mColumns[query.mColumns[i]].mOffset;
+		}
+		return query;
+	}
+
+	template <typename... Ts>
+	void MarkWritten(const Archetype& archetype, const Chunk& chunk, const QueryColumns<sizeof...(Ts)>& query) const
+	{
+		constexpr bool isWritten[] = {!std::is_const_v<Ts>..., false};
+		uint32_t* ticks = ChangeTicks(archetype, chunk);
+		for (size_t i = 0; i < sizeof...(Ts); ++i)
+		{
+			if (isWritten[i])
+			{
+				ticks[query.mColumns[i]] = mTick;
+			}
+		}
+	}
+
+	static uint32_t* ChangeTicks(const Archetype& archetype, const Chunk& chunk)
+	{
+		return reinterpret_cast<uint32_t*>(chunk.mData + archetype.mTicksOffset);
+	}
+
+	void MarkChunkChanged(const Archetype& archetype, const Chunk& chunk) const
+	{
+		uint32_t* ticks = ChangeTicks(archetype, chunk);
+		for (size_t i = 0; i < archetype.mColumns.Size(); ++i)
+		{
+			ticks[i] = mTick;
+		}
+	}
+
+	template <typename... Ts, typename Callback, size_t... Is>
+	static void CallWithChunk(Chunk& chunk, const uint32_t* offsets, Callback& callback, std::index_sequence<Is...>)
+	{
+		callback(size_t(chunk.mCount), reinterpret_cast<const Entity*>(chunk.mData),
+				 reinterpret_cast<Ts*>(chunk.mData + offsets[Is])...);
+	}
+
+	static void* ColumnData(const Chunk& chunk, const Column& column, uint32_t row)
+	{
+		return chunk.mData + column.mOffset + size_t(row) * column.mInfo->mSize;
+	}
+
+	static Entity* EntityData(const Chunk& chunk) { return reinterpret_cast<Entity*>(chunk.mData); }
+
+	void* ComponentData(const Record& record, uint32_t typeId) const
+	{
+		const Archetype& archetype = mArchetypes[record.mArchetype];
+		if (!archetype.mMask.Test(typeId))
+		{
+			return nullptr;
+		}
+		return ColumnData(archetype.mChunks[record.mChunk], archetype.mColumns[archetype.ColumnIndex(typeId)], record.mRow);
+	}
+
+	uint32_t FindOrCreateArchetype(const ComponentMask& mask)
+	{
+		for (size_t i = 0; i < mArchetypes.Size(); ++i)
+		{
+			if (mArchetypes[i].mMask == mask)
+			{
+				return uint32_t(i);
+			}
+		}
+
+		// Copy of empty archetype has the same allocators
+		mArchetypes.Add(mEmptyArchetype);
+		Archetype* archetype = &mArchetypes.Back();
+		archetype->mMask = mask;
+		mask.ForEach([&](uint32_t typeId) { archetype->mColumns.Add(Column{&GetComponentTypeInfo(typeId), 0}); });
+
+		// Entity handles are followed by component arrays and change ticks. Find largest capacity for which all arrays fit to
+		// chunk.
+		size_t rowSize = sizeof(Entity);
+		size_t padding = archetype->mColumns.Size() * sizeof(uint32_t);
+		for (size_t i = 0; i < archetype->mColumns.Size(); ++i)
+		{
+			rowSize += archetype->mColumns[i].mInfo->mSize;
+			padding += archetype->mColumns[i].mInfo->mAlignment;
+		}
+		uint32_t capacity = uint32_t((ChunkSize - ion::Min(padding, ChunkSize)) / rowSize);
+		for (;;)
+		{
+			ION_ASSERT(capacity > 0, "Components do not fit to chunk");
+			size_t offset = sizeof(Entity) * capacity;
+			for (size_t i = 0; i < archetype->mColumns.Size(); ++i)
+			{
+				Column& column = archetype->mColumns[i];
+				ION_ASSERT(column.mInfo->mAlignment <= ChunkAlignment, "Unsupported component alignment");
+				offset = (offset + column.mInfo->mAlignment - 1) / column.mInfo->mAlignment * column.mInfo->mAlignment;
+				column.mOffset = uint32_t(offset);
+				offset += size_t(column.mInfo->mSize) * capacity;
+			}
+			offset = (offset + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+			archetype->mTicksOffset = uint32_t(offset);
+			offset += archetype->mColumns.Size() * sizeof(uint32_t);
+			if (offset <= ChunkSize)
+			{
+				break;
+			}
+			capacity--;
+		}
+		archetype->mCapacity = capacity;
+		return uint32_t(mArchetypes.Size() - 1);
+	}
+
+	uint32_t AddTransition(uint32_t source, uint32_t typeId)
+	{
+		if (const uint32_t* target = mArchetypes[source].mAddTransitions.Lookup(typeId))
+		{
+			return *target;
+		}
+		ComponentMask mask = mArchetypes[source].mMask;
+		mask.Set(typeId);
+		const uint32_t target = FindOrCreateArchetype(mask);
+		mArchetypes[source].mAddTransitions.Insert(typeId, target);
+		mArchetypes[target].mRemoveTransitions.Insert(typeId, source);
+		return target;
+	}
+
+	uint32_t RemoveTransition(uint32_t source, uint32_t typeId)
+	{
+		if (const uint32_t* target = mArchetypes[source].mRemoveTransitions.Lookup(typeId))
+		{
+			return *target;
+		}
+		ComponentMask mask = mArchetypes[source].mMask;
+		mask.Reset(typeId);
+		const uint32_t target = FindOrCreateArchetype(mask);
+		mArchetypes[source].mRemoveTransitions.Insert(typeId, target);
+		mArchetypes[target].mAddTransitions.Insert(typeId, source);
+		return target;
+	}
+
+	// Reserves row for entity at the end of archetype. Components are not constructed.
+	void AddRow(uint32_t archetypeIndex, Entity entity)
+	{
+		Archetype& archetype = mArchetypes[archetypeIndex];
+		if (archetype.mChunks.IsEmpty() || archetype.mChunks.Back().mCount == archetype.mCapacity)
+		{
+			archetype.mChunks.Add(Chunk{static_cast<uint8_t*>(mAllocator.AllocateRaw(ChunkSize, ChunkAlignment)), 0});
+		}
+		Chunk& chunk = archetype.mChunks.Back();
+		const uint32_t row = chunk.mCount++;
+		EntityData(chunk)[row] = entity;
+		archetype.mSize++;
+		MarkChunkChanged(archetype, chunk);
+
+		Record& record = mRecords[entity.Index()];
+		record.mArchetype = archetypeIndex;
+		record.mChunk = uint32_t(archetype.mChunks.Size() - 1);
+		record.mRow = row;
+	}
+
+	// Moves last entity of archetype to the row. Components of the row must be already destroyed or relocated.
+	void RemoveRow(uint32_t archetypeIndex, uint32_t chunkIndex, uint32_t row)
+	{
+		Archetype& archetype = mArchetypes[archetypeIndex];
+		Chunk& chunk = archetype.mChunks[chunkIndex];
+		Chunk& lastChunk = archetype.mChunks.Back();
+		const uint32_t lastRow = lastChunk.mCount - 1;
+		if (&chunk != &lastChunk || row != lastRow)
+		{
+			const Entity moved = EntityData(lastChunk)[lastRow];
+			EntityData(chunk)[row] = moved;
+			for (size_t i = 0; i < archetype.mColumns.Size(); ++i)
+			{
+				const Column& column = archetype.mColumns[i];
+				RelocateComponents(column.mInfo, ColumnData(chunk, column, row), ColumnData(lastChunk, column, lastRow), 1);
+			}
+			Record& record = mRecords[moved.Index()];
+			record.mChunk = chunkIndex;
+			record.mRow = row;
+			MarkChunkChanged(archetype, chunk);
+		}
+		lastChunk.mCount--;
+		archetype.mSize--;
+		if (lastChunk.mCount == 0)
+		{
+			mAllocator.DeallocateRaw(lastChunk.mData, ChunkSize, ChunkAlignment);
+			archetype.mChunks.Pop();
+		}
+	}
+
+	static void RelocateComponents(const ComponentTypeInfo* info, void* destination, void* source, size_t count)
+	{
+		if (info->mRelocate)
+		{
+			info->mRelocate(destination, source, count);
+		}
+		else
+		{
+			std::memcpy(destination, source, size_t(info->mSize) * count);
+		}
+	}
+
+	// Moves entity to target archetype. Components not in target are destroyed and components not in source are left
+	// unconstructed.
+	void MoveEntity(Record& record, uint32_t target)
+	{
+		const uint32_t source = record.mArchetype;
+		const uint32_t sourceChunk = record.mChunk;
+		const uint32_t sourceRow = record.mRow;
+		const Entity entity = EntityData(mArchetypes[source].mChunks[sourceChunk])[sourceRow];
+		AddRow(target, entity);
+
+		const Archetype& from = mArchetypes[source];
+		const Archetype& to = mArchetypes[target];
+		const Chunk& fromChunk = from.mChunks[sourceChunk];
+		const Chunk& toChunk = to.mChunks[record.mChunk];
+
+		// Both column lists are sorted by type id
+		size_t j = 0;
+		for (size_t i = 0; i < from.mColumns.Size(); ++i)
+		{
+			const Column& column = from.mColumns[i];
+			while (j < to.mColumns.Size() && to.mColumns[j].mInfo->mId < column.mInfo->mId)
+			{
+				++j;
+			}
+			void* data = ColumnData(fromChunk, column, sourceRow);
+			if (j < to.mColumns.Size() && to.mColumns[j].mInfo->mId == column.mInfo->mId)
+			{
+				RelocateComponents(column.mInfo, ColumnData(toChunk, to.mColumns[j], record.mRow), data, 1);
+			}
+			else if (column.mInfo->mDestroy)
+			{
+				column.mInfo->mDestroy(data, 1);
+			}
+		}
+		RemoveRow(source, sourceChunk, sourceRow);
+	}
+
+	VectorOf<Archetype> mArchetypes;
+	VectorOf<Record> mRecords;
+	ion::BitIdPool<uint32_t, typename std::allocator_traits<TAllocator>::template rebind_alloc<uint32_t>> mEntityIds;
+	ByteAllocator mAllocator;
+	Archetype mEmptyArchetype;
+	uint32_t mTick = 1;
+};
+}  // namespace ion
@@ -30,6 +30,7 @@
 	#define ION_COMPONENT_READ_WRITE_CHECKS ION_CONFIG_ERROR_CHECKING
 #endif
 
+// Cache tracking of component stores: 0 - disabled, 1 - cache simulation, 2 - hardware counters with fallback to simulation
 #ifndef ION_COMPONENT_SUPPORT_CACHE_TRACKING
 	#define ION_COMPONENT_SUPPORT_CACHE_TRACKING 0
 #endif
@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 #pragma once
+#include <ion/container/Sort.h>
+#include <ion/database/DBSnapshot.h>
 #include <ion/util/IdRangePool.h>
 
+#include <algorithm>
+
 namespace ion
 {
 // #TODO: Replace these with proper memory allocators
@@ -24,6 +28,7 @@ class ComponentDataVector
 {
 	ion::IdRangePool<TContainerSize> mIdGroupPool;
 	ion::Vector<TData, GlobalAllocator<TData>, TContainerSize> mData;
+	TContainerSize mNumLiveItems = 0;
 
 public:
 	ComponentDataVector() {}
@@ -40,6 +45,7 @@ public:
 	{
 		const auto offset = sizeof(TDataSize);
 		AddResult result(mIdGroupPool.Reserve(size + offset));
+		mNumLiveItems += size + offset;
 		const auto requiredSize = result.pos + size + offset;
 		if (mData.Size() < requiredSize)
 		{
@@ -58,7 +64,20 @@ public:
 		return result;
 	}
 
-	void Remove(TContainerSize pos) { mIdGroupPool.Free(pos, GetSize(pos) + sizeof(TDataSize)); }
+	void Remove(TContainerSize pos)
+	{
+		const TContainerSize count = GetSize(pos) + sizeof(TDataSize);
+		mNumLiveItems -= count;
+		if (mIsCompacting && pos >= mCompactRead)
+		{
+			// Not reached by compaction yet, compaction must know that range is free
+			auto iter = std::lower_bound(mCompactFreeRanges.Begin() + mCompactNextFree, mCompactFreeRanges.End(), pos,
+										 [](const FreeRange& range, TContainerSize index) { return range.mIndex < index; });
+			mCompactFreeRanges.Insert(iter, FreeRange{pos, count});
+			return;
+		}
+		mIdGroupPool.Free(pos, count);
+	}
 
 	inline const MultiData<TData, TContainerSize> Get(TContainerSize pos) const
 	{
@@ -67,7 +86,193 @@ public:
 		return MultiData<TData, TContainerSize>(data, size);
 	}
 
+	// Items used by data including size headers
+	[[nodiscard]] TContainerSize NumLiveItems() const { return mNumLiveItems; }
+
+	// Share of free items in the used range [0, Max()), i.e. how much compaction can shrink the data.
+	[[nodiscard]] float Fragmentation() const
+	{
+		const TContainerSize max = mIdGroupPool.Max();
+		return max == 0 ? 0.0f : float(max - mNumLiveItems) / float(max);
+	}
+
+	struct Relocation
+	{
+		TContainerSize mFrom;
+		TContainerSize mTo;
+	};
+
+	// Incremental compaction. Moves data runs after the first free range toward the front until at least 'maxItems' items
+	// are moved or there is nothing left to move. Moved runs are added to 'relocations' as positions returned by Add(); user
+	// must update stored positions. Data returned by Get() is invalidated. Returns true when there are no free ranges left,
+	// in which case excess capacity is released.
+	//
+	// Compaction continues from where the previous call stopped. Free ranges are sorted once when compaction starts, after
+	// that cost of a call depends only on the items moved. Free ranges that compaction has not reached yet are not reused by
+	// Add() before compaction has finished.
+	bool Compact(TContainerSize maxItems, ion::Vector<Relocation>& relocations)
+	{
+		if (!mIsCompacting)
+		{
+			if (mNumLiveItems == mIdGroupPool.Max())
+			{
+				ReleaseUnusedData();
+				return true;
+			}
+			BeginCompaction();
+		}
+
+		TContainerSize numMoved = 0;
+		while (mCompactRead < mIdGroupPool.Max() && numMoved < maxItems)
+		{
+			if (mCompactNextFree < mCompactFreeRanges.Size() && mCompactFreeRanges[mCompactNextFree].mIndex == mCompactRead)
+			{
+				// Hole grows by skipped free range
+				mCompactRead += mCompactFreeRanges[mCompactNextFree].mCount;
+				mCompactNextFree++;
+				continue;
+			}
+			const TContainerSize count = GetSize(mCompactRead) + sizeof(TDataSize);
+			memmove(reinterpret_cast<char*>(&mData[mCompactWrite]), reinterpret_cast<const char*>(&mData[mCompactRead]),
+					count * sizeof(TData));
+			relocations.Add(Relocation{mCompactRead, mCompactWrite});
+			mCompactWrite += count;
+			mCompactRead += count;
+			numMoved += count;
+		}
+		if (mCompactRead < mIdGroupPool.Max())
+		{
+			return false;
+		}
+
+		// Hole reached the end and is released. Free ranges left behind are the ones removed during compaction.
+		ION_ASSERT(mCompactNextFree == mCompactFreeRanges.Size(), "Free ranges left after compaction");
+		mIsCompacting = false;
+		mCompactFreeRanges.Clear();
+		if (mCompactRead != mCompactWrite)
+		{
+			mIdGroupPool.Free(mCompactWrite, mCompactRead - mCompactWrite);
+		}
+		if (mNumLiveItems != mIdGroupPool.Max())
+		{
+			return false;
+		}
+		ReleaseUnusedData();
+		return true;
+	}
+
+	// Writes data and free ranges, thus positions stay valid when snapshot is loaded
+	void SaveSnapshot(ion::ByteWriter& writer, uint64_t schemaHash) const
+	{
+		static_assert(std::is_trivially_copyable_v<TData>, "Snapshot requires trivially copyable data");
+		ion::Vector<TContainerSize> freeRanges;
+		ForEachFreeRange(
+		  [&](TContainerSize index, TContainerSize count)
+		  {
+			  freeRanges.Add(index);
+			  freeRanges.Add(count);
+		  });
+		WriteSnapshotHeader<TData>(writer, schemaHash, size_t(mData.Size()));
+		const uint64_t info[] = {uint64_t(mIdGroupPool.Max()), uint64_t(freeRanges.Size())};
+		WriteSnapshotArray(writer, info, 2);
+		WriteSnapshotArray(writer, freeRanges.Data(), freeRanges.Size());
+		WriteSnapshotArray(writer, mData.Data(), mData.Size());
+	}
+
+	// Returns false if snapshot is invalid. Vector is empty after failed load.
+	[[nodiscard]] bool LoadSnapshot(ion::ByteReader& reader, uint64_t schemaHash)
+	{
+		mIdGroupPool.Reset(0);
+		mData.Clear();
+		mNumLiveItems = 0;
+		mIsCompacting = false;
+		mCompactFreeRanges.Clear();
+		SnapshotHeader header;
+		uint64_t info[2];
+		if (!ReadSnapshotHeader<TData>(reader, schemaHash, header) || !ReadSnapshotArray(reader, info, 2) ||
+			header.mCount > (std::numeric_limits<TContainerSize>::max)() || info[0] > header.mCount || info[1] % 2 != 0)
+		{
+			return false;
+		}
+		ion::Vector<TContainerSize> freeRanges;
+		freeRanges.Resize(size_t(info[1]));
+		mData.Resize(size_t(header.mCount));
+		if (!ReadSnapshotArray(reader, freeRanges.Data(), freeRanges.Size()) ||
+			!ReadSnapshotArray(reader, mData.Data(), mData.Size()))
+		{
+			mData.Clear();
+			return false;
+		}
+		mIdGroupPool.Reset(TContainerSize(info[0]));
+		mNumLiveItems = mIdGroupPool.Max();
+		for (size_t i = 0; i < freeRanges.Size(); i += 2)
+		{
+			mIdGroupPool.Free(freeRanges[i], freeRanges[i + 1]);
+			mNumLiveItems -= freeRanges[i + 1];
+		}
+		return true;
+	}
+
 private:
+	struct FreeRange
+	{
+		TContainerSize mIndex;
+		TContainerSize mCount;
+	};
+
+	// Takes free ranges out of pool in position order. Compaction starts from the first free range.
+	void BeginCompaction()
+	{
+		mCompactFreeRanges.Clear();
+		mIdGroupPool.ForEachFreeRange([&](TContainerSize index, TContainerSize count) { mCompactFreeRanges.Add(FreeRange{index, count}); });
+		ion::Sort(mCompactFreeRanges.Begin(), mCompactFreeRanges.End(),
+				  [](const FreeRange& a, const FreeRange& b) { return a.mIndex < b.mIndex; });
+		mIdGroupPool.Reset(mIdGroupPool.Max());
+		mCompactWrite = mCompactFreeRanges[0].mIndex;
+		mCompactRead = mCompactWrite + mCompactFreeRanges[0].mCount;
+		mCompactNextFree = 1;
+		mIsCompacting = true;
+	}
+
+	// Free ranges of pool and ranges held by ongoing compaction
+	template <typename Callback>
+	void ForEachFreeRange(Callback&& callback) const
+	{
+		mIdGroupPool.ForEachFreeRange(callback);
+		if (mIsCompacting)
+		{
+			if (mCompactRead != mCompactWrite)
+			{
+				callback(mCompactWrite, TContainerSize(mCompactRead - mCompactWrite));
+			}
+			for (size_t i = mCompactNextFree; i < mCompactFreeRanges.Size(); ++i)
+			{
+				callback(mCompactFreeRanges[i].mIndex, mCompactFreeRanges[i].mCount);
+			}
+		}
+	}
+
+	// Drops items after the used range and releases capacity when less than half of it is used
+	void ReleaseUnusedData()
+	{
+		const TContainerSize max = mIdGroupPool.Max();
+		if (mData.Size() > max)
+		{
+			mData.Resize(max);
+		}
+		if (mData.Capacity() > max * 2)
+		{
+			mData.ShrinkToFit();
+		}
+	}
+
 	inline const TDataSize GetSize(TContainerSize pos) const { return reinterpret_cast<const TDataSize&>(mData[pos]); }
+
+	// State of ongoing compaction: hole [mCompactWrite, mCompactRead) and free ranges after it are not in the pool
+	ion::Vector<FreeRange> mCompactFreeRanges;
+	size_t mCompactNextFree = 0;
+	TContainerSize mCompactWrite = 0;
+	TContainerSize mCompactRead = 0;
+	bool mIsCompacting = false;
 };
 }  // namespace ion
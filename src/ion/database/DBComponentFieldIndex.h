@@ -0,0 +1,363 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <ion/container/BTreeMap.h>
+#include <ion/container/UnorderedMap.h>
+#include <ion/container/Vector.h>
+#include <ion/debug/Profiling.h>
+#include <ion/jobs/JobScheduler.h>
+#include <ion/jobs/ParallelSort.h>
+
+// Secondary indexes of component stores keyed on a component field.
+//
+// Indexes map component index to key and key to component indices. Index is not updated automatically, it is kept up to
+// date either
+// - incrementally by calling Set() and Remove() where the component store writes the field or deletes components, or
+// - by calling Refresh() once per tick, before the index is used, with tick of the previous refresh. Refresh uses change
+//   tracking of ComponentStore, i.e. indices created or deleted via CreateIndex() and DeleteIndex() and indices accessed
+//   via mutable views, and updates changed indices, or rebuilds the whole index in parallel when large part of the store has
+//   changed.
+//
+// Key getter is called as bool(TIndex index, TKey& key) and returns false if index is not in use.
+namespace ion
+{
+namespace detail
+{
+template <typename TDerived, typename TIndex, typename TKey>
+class FieldIndexBase
+{
+public:
+	// Refresh() rebuilds whole index when more than 1/RebuildRatio of indices have changed
+	static constexpr size_t RebuildRatio = 4;
+
+	[[nodiscard]] bool Contains(TIndex index) const { return size_t(index) < mIsIndexed.Size() && mIsIndexed[index] != 0; }
+
+	[[nodiscard]] const TKey& Key(TIndex index) const
+	{
+		ION_ASSERT(Contains(index), "Index not indexed");
+		return mKeys[index];
+	}
+
+	// Number of indexed components
+	[[nodiscard]] size_t Size() const { return mSize; }
+
+	// Updates indices of store changed after the tick, or rebuilds index if large part of store has changed. Use store's
+	// Tick() at the previous refresh as 'sinceTick' and advance store's tick after refresh, thus later writes are newer.
+	template <typename TStore, typename GetKey>
+	void Refresh(const TStore& store, uint32_t sinceTick, GetKey&& getKey, ion::JobScheduler& js)
+	{
+		TDerived& self = static_cast<TDerived&>(*this);
+		size_t numChanged = 0;
+		store.ForEachChangedRange(sinceTick, [&](TIndex first, TIndex last) { numChanged += size_t(last - first); });
+		if (numChanged > size_t(store.Max()) / RebuildRatio)
+		{
+			self.Rebuild(store.Max(), getKey, js);
+			return;
+		}
+		store.ForEachChangedRange(sinceTick,
+								  [&](TIndex first, TIndex last)
+								  {
+									  for (TIndex i = first; i < last; ++i)
+									  {
+										  TKey key;
+										  if (getKey(i, key))
+										  {
+											  self.Set(i, key);
+										  }
+										  else
+										  {
+											  self.Remove(i);
+										  }
+									  }
+								  });
+	}
+
+protected:
+	void Reserve(TIndex index)
+	{
+		if (mIsIndexed.Size() <= size_t(index))
+		{
+			mKeys.Resize(size_t(index) + 1, (size_t(index) + 1) * 2);
+			mIsIndexed.Resize(size_t(index) + 1, (size_t(index) + 1) * 2);
+		}
+	}
+
+	// Fills keys of indices [0, numIndices) in parallel
+	template <typename GetKey>
+	void ExtractKeys(TIndex numIndices, GetKey&& getKey, ion::JobScheduler& js)
+	{
+		mKeys.Clear();
+		mIsIndexed.Clear();
+		mKeys.Resize(numIndices);
+		mIsIndexed.Resize(numIndices);
+		const UInt partitionSize = ion::JobScheduler::DefaultPartitionSize(numIndices);
+		js.ParallelForIndex(0, numIndices, partitionSize, ion::JobScheduler::DefaultBatchSize<TKey>(numIndices, partitionSize),
+							[&](UInt i) { mIsIndexed[i] = getKey(TIndex(i), mKeys[i]) ? 1 : 0; });
+	}
+
+	ion::Vector<TKey> mKeys;
+	ion::Vector<uint8_t> mIsIndexed;
+	size_t mSize = 0;
+};
+}  // namespace detail
+
+// Hashed index for equality lookups. Components of the same key are linked, thus lookup is a single hash map lookup and
+// iterating components of key does not allocate.
+template <typename TIndex, typename TKey, typename THasher = ion::Hasher<TKey>>
+class HashFieldIndex : public detail::FieldIndexBase<HashFieldIndex<TIndex, TKey, THasher>, TIndex, TKey>
+{
+	using Super = detail::FieldIndexBase<HashFieldIndex<TIndex, TKey, THasher>, TIndex, TKey>;
+
+public:
+	static constexpr TIndex InvalidIndex = static_cast<TIndex>(-1);
+
+	// Adds index or updates key of index
+	void Set(TIndex index, const TKey& key)
+	{
+		if (Super::Contains(index))
+		{
+			if (Super::mKeys[index] == key)
+			{
+				return;
+			}
+			Unlink(index);
+		}
+		else
+		{
+			Super::Reserve(index);
+			mLinks.Resize(Super::mIsIndexed.Size(), Super::mIsIndexed.Capacity());
+			Super::mIsIndexed[index] = 1;
+			Super::mSize++;
+		}
+		Super::mKeys[index] = key;
+		Link(index);
+	}
+
+	void Remove(TIndex index)
+	{
+		if (Super::Contains(index))
+		{
+			Unlink(index);
+			Super::mIsIndexed[index] = 0;
+			Super::mSize--;
+		}
+	}
+
+	void Clear()
+	{
+		mHeads.Clear();
+		mLinks.Clear();
+		Super::mKeys.Clear();
+		Super::mIsIndexed.Clear();
+		Super::mSize = 0;
+	}
+
+	// Calls callback(TIndex index) for each component with the key
+	template <typename Callback>
+	void ForEach(const TKey& key, Callback&& callback) const
+	{
+		const TIndex* head = mHeads.Lookup(key);
+		for (TIndex index = head ? *head : InvalidIndex; index != InvalidIndex; index = mLinks[index].mNext)
+		{
+			callback(index);
+		}
+	}
+
+	[[nodiscard]] TIndex Count(const TKey& key) const
+	{
+		TIndex count = 0;
+		ForEach(key, [&](TIndex) { count++; });
+		return count;
+	}
+
+	// Rebuilds index from indices [0, numIndices). Keys are read in parallel.
+	template <typename GetKey>
+	void Rebuild(TIndex numIndices, GetKey&& getKey, ion::JobScheduler& js)
+	{
+		ION_PROFILER_SCOPE_DETAIL(Job, "Rebuild hash field index", size_t(numIndices));
+		mHeads.Clear();
+		Super::ExtractKeys(numIndices, getKey, js);
+		mLinks.Clear();
+		mLinks.Resize(numIndices);
+		Super::mSize = 0;
+		// Link in reverse to keep lists in index order
+		for (TIndex i = numIndices; i-- > 0;)
+		{
+			if (Super::mIsIndexed[i])
+			{
+				Link(i);
+				Super::mSize++;
+			}
+		}
+	}
+
+private:
+	struct Links
+	{
+		TIndex mPrev;
+		TIndex mNext;
+	};
+
+	void Link(TIndex index)
+	{
+		auto iter = mHeads.Find(Super::mKeys[index]);
+		mLinks[index].mPrev = InvalidIndex;
+		if (iter == mHeads.End())
+		{
+			mLinks[index].mNext = InvalidIndex;
+			mHeads.Insert(Super::mKeys[index], index);
+		}
+		else
+		{
+			mLinks[index].mNext = iter->second;
+			mLinks[iter->second].mPrev = index;
+			iter->second = index;
+		}
+	}
+
+	void Unlink(TIndex index)
+	{
+		const Links links = mLinks[index];
+		if (links.mNext != InvalidIndex)
+		{
+			mLinks[links.mNext].mPrev = links.mPrev;
+		}
+		if (links.mPrev != InvalidIndex)
+		{
+			mLinks[links.mPrev].mNext = links.mNext;
+		}
+		else if (links.mNext != InvalidIndex)
+		{
+			mHeads[Super::mKeys[index]] = links.mNext;
+		}
+		else
+		{
+			mHeads.Remove(Super::mKeys[index]);
+		}
+	}
+
+	ion::UnorderedMap<TKey, TIndex, THasher> mHeads;  // First index of each key
+	ion::Vector<Links> mLinks;
+};
+
+// Sorted index for range queries. Entries are ordered by key and then by component index.
+template <typename TIndex, typename TKey>
+class SortedFieldIndex : public detail::FieldIndexBase<SortedFieldIndex<TIndex, TKey>, TIndex, TKey>
+{
+	using Super = detail::FieldIndexBase<SortedFieldIndex<TIndex, TKey>, TIndex, TKey>;
+
+public:
+	// Adds index or updates key of index
+	void Set(TIndex index, const TKey& key)
+	{
+		if (Super::Contains(index))
+		{
+			if (!(Super::mKeys[index] < key) && !(key < Super::mKeys[index]))
+			{
+				return;
+			}
+			mEntries.Remove(Entry{Super::mKeys[index], index});
+		}
+		else
+		{
+			Super::Reserve(index);
+			Super::mIsIndexed[index] = 1;
+			Super::mSize++;
+		}
+		Super::mKeys[index] = key;
+		mEntries.Add(Entry{key, index});
+	}
+
+	void Remove(TIndex index)
+	{
+		if (Super::Contains(index))
+		{
+			mEntries.Remove(Entry{Super::mKeys[index], index});
+			Super::mIsIndexed[index] = 0;
+			Super::mSize--;
+		}
+	}
+
+	void Clear()
+	{
+		mEntries.Clear();
+		Super::mKeys.Clear();
+		Super::mIsIndexed.Clear();
+		Super::mSize = 0;
+	}
+
+	// Calls callback(TIndex index) for each component with key in range [first, last) in key order
+	template <typename Callback>
+	void ForEachInRange(const TKey& first, const TKey& last, Callback&& callback) const
+	{
+		mEntries.ForEachInRange(Entry{first, 0}, Entry{last, 0}, [&](const Entry& entry) { callback(entry.mIndex); });
+	}
+
+	// Calls callback(TIndex index) for each component with key less than 'last' in key order
+	template <typename Callback>
+	void ForEachLess(const TKey& last, Callback&& callback) const
+	{
+		for (auto iter = mEntries.Begin(); iter != mEntries.End() && iter.Key().mKey < last; ++iter)
+		{
+			callback(iter.Key().mIndex);
+		}
+	}
+
+	// Calls callback(TIndex index) for each component with the key
+	template <typename Callback>
+	void ForEach(const TKey& key, Callback&& callback) const
+	{
+		for (auto iter = mEntries.LowerBound(Entry{key, 0}); iter != mEntries.End() && !(key < iter.Key().mKey); ++iter)
+		{
+			callback(iter.Key().mIndex);
+		}
+	}
+
+	// Rebuilds index from indices [0, numIndices). Keys are read and sorted in parallel.
+	template <typename GetKey>
+	void Rebuild(TIndex numIndices, GetKey&& getKey, ion::JobScheduler& js)
+	{
+		ION_PROFILER_SCOPE_DETAIL(Job, "Rebuild sorted field index", size_t(numIndices));
+		Super::ExtractKeys(numIndices, getKey, js);
+		ion::Vector<Entry> entries;
+		entries.Reserve(numIndices);
+		for (TIndex i = 0; i < numIndices; ++i)
+		{
+			if (Super::mIsIndexed[i])
+			{
+				entries.Add(Entry{Super::mKeys[i], i});
+			}
+		}
+		ion::Sort(entries.Begin(), entries.End(), js);
+		mEntries.BuildSorted(entries.Begin(), entries.End());
+		Super::mSize = entries.Size();
+	}
+
+private:
+	struct Entry
+	{
+		TKey mKey;
+		TIndex mIndex;
+
+		bool operator<(const Entry& other) const
+		{
+			return mKey < other.mKey || (!(other.mKey < mKey) && mIndex < other.mIndex);
+		}
+	};
+
+	ion::BTreeSet<Entry> mEntries;
+};
+}  // namespace ion
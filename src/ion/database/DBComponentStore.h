@@ -14,8 +14,11 @@
  * limitations under the License.
  */
 #pragma once
-#include <ion/util/IdPool.h>
+#include <ion/util/BitIdPool.h>
 #include <ion/database/DBComponentStoreBase.h>
+#include <ion/database/DBSnapshot.h>
+
+#include <atomic>
 
 namespace ion
 {
@@ -34,11 +37,49 @@ public:
 
 	static constexpr T INVALID_INDEX = static_cast<T>(-1);
 
+	// Indices are in range [0, Max())
+	[[nodiscard]] T Max() const { return mIndexPool.Max(); }
+
+	// Changes are tracked per block of indices and stamped with current tick. Ticks wrap around, thus ticks compared must be
+	// less than 2^31 ticks apart.
+	static constexpr size_t ChangeBlockShift = 6;
+
+	uint32_t Tick() const { return mTick; }
+
+	void AdvanceTick() { mTick++; }
+
+	// Calls callback(T first, T last) for ranges of indices that have blocks changed after the tick. Range may contain indices
+	// that are not in use. Indices are changed when they are created or deleted, when mutable view to them is created, or when
+	// derived store calls MarkChanged().
+	template <typename Callback>
+	void ForEachChangedRange(uint32_t sinceTick, Callback&& callback) const
+	{
+		// Blocks after Max() may be left from before Shrink()
+		const size_t numBlocks = ion::Min(size_t(mChangeTicks.Size()), NumChangeBlocks(mIndexPool.Max()));
+		size_t block = 0;
+		while (block < numBlocks)
+		{
+			if (int32_t(mChangeTicks[block] - sinceTick) <= 0)
+			{
+				block++;
+				continue;
+			}
+			const size_t first = block;
+			do
+			{
+				block++;
+			} while (block < numBlocks && int32_t(mChangeTicks[block] - sinceTick) > 0);
+			callback(static_cast<T>(first << ChangeBlockShift),
+					 static_cast<T>(ion::Min(block << ChangeBlockShift, size_t(mIndexPool.Max()))));
+		}
+	}
+
 #if ION_COMPONENT_READ_WRITE_CHECKS
 	void OnCreated(T index)
 	{
 		ION_CHECK(mStoreGuard.IsFree(), "Cannot use components when creating or deleting componets");
 		mFieldGuard[index].StartWriting();
+		MarkChanged(index);
 	}
 
 	void OnDeleted(T index)
@@ -60,19 +101,60 @@ public:
 	}
 
 #else
-	void OnCreated(T) {}
+	void OnCreated(T index) { MarkChanged(index); }
 	void OneDeleted(T) {}
 	void OnCreated(T) const {}
 	void OnDeleted(T) const {}
 #endif
 
+	// Writes snapshot of index pool and components [0, Max()). Components of free indices are written as they are.
+	template <typename TComponent>
+	void SaveSnapshot(ion::ByteWriter& writer, uint64_t schemaHash, const TComponent* components) const
+	{
+		WriteSnapshotHeader<TComponent>(writer, schemaHash, size_t(mIndexPool.Max()));
+		WriteSnapshotArray(writer, mIndexPool.FreeBitWords(), mIndexPool.NumFreeBitWords());
+		WriteSnapshotArray(writer, components, size_t(mIndexPool.Max()));
+	}
+
+	// Restores index pool and copies components to vector of components. Returns false if snapshot is invalid.
+	template <typename TComponent, typename TVector>
+	[[nodiscard]] bool LoadSnapshot(ion::ByteReader& reader, uint64_t schemaHash, TVector& components)
+	{
+		if (!LoadSnapshotIndexPool<TComponent>(reader, schemaHash))
+		{
+			return false;
+		}
+		components.Resize(size_t(mIndexPool.Max()));
+		if (!ReadSnapshotArray(reader, components.Data(), size_t(mIndexPool.Max())))
+		{
+			mIndexPool.Reset();
+			return false;
+		}
+		return true;
+	}
+
+	// Restores index pool and returns components in reader's buffer, e.g. memory mapped file, without copying. Returns nullptr
+	// if snapshot is invalid or components are not aligned in buffer.
+	template <typename TComponent>
+	[[nodiscard]] const TComponent* LoadSnapshotInPlace(ion::ByteReader& reader, uint64_t schemaHash)
+	{
+		if (!LoadSnapshotIndexPool<TComponent>(reader, schemaHash))
+		{
+			return nullptr;
+		}
+		const TComponent* components = ViewSnapshotArray<TComponent>(reader, size_t(mIndexPool.Max()));
+		if (components == nullptr)
+		{
+			mIndexPool.Reset();
+		}
+		return components;
+	}
+
 protected:
-#if ION_COMPONENT_READ_WRITE_CHECKS || ION_COMPONENT_VERSION_NUMBER
 	void CloneProtection(const ComponentStore<T, Allocator>& other)
-#else
-	void CloneProtection(const ComponentStore<T, Allocator>&)
-#endif
 	{
+		mChangeTicks = other.mChangeTicks;
+		mTick = other.mTick;
 #if ION_COMPONENT_READ_WRITE_CHECKS
 		mFieldGuard.Resize(other.mFieldGuard.Size());
 #endif
@@ -87,12 +169,15 @@ protected:
 	void IncreaseVersion(T index) { mVersions[index]++; }
 #endif
 
-#if ION_COMPONENT_READ_WRITE_CHECKS || ION_COMPONENT_VERSION_NUMBER
+	// Makes room for index in protection and change tracking. Must be called when index is created, not concurrently with
+	// access to other indices.
 	void ResizeProtection(T index)
-#else
-	void ResizeProtection(T)
-#endif
 	{
+		const size_t block = size_t(index) >> ChangeBlockShift;
+		if (mChangeTicks.Size() <= block)
+		{
+			mChangeTicks.Resize(block + 1, (block + 1) * 2);
+		}
 #if ION_COMPONENT_READ_WRITE_CHECKS
 		if (mFieldGuard.Size() <= index)
 		{
@@ -107,9 +192,71 @@ protected:
 #endif
 	}
 
-	ion::IdPool<T, Allocator> mIndexPool;
+	// Mutable access to index must be marked for change tracking. Can be called concurrently, change block of index is
+	// allocated by ResizeProtection() when index is created.
+	void MarkChanged(T index)
+	{
+		const size_t block = size_t(index) >> ChangeBlockShift;
+		ION_ASSERT(block < mChangeTicks.Size(), "Index " << index << " not created via CreateIndex() or ResizeProtection()");
+		std::atomic_ref<uint32_t>(mChangeTicks[block]).store(mTick, std::memory_order_relaxed);
+	}
+
+	// Derived stores should create and delete components using these to keep change tracking and protection up to date
+	T CreateIndex()
+	{
+		const T index = mIndexPool.Reserve();
+		ResizeProtection(index);
+		MarkChanged(index);
+		return index;
+	}
+
+	void DeleteIndex(T index)
+	{
+		MarkChanged(index);
+		mIndexPool.Free(index);
+	}
+
+	ion::BitIdPool<T, Allocator> mIndexPool;
 
 private:
+	template <typename TComponent>
+	bool LoadSnapshotIndexPool(ion::ByteReader& reader, uint64_t schemaHash)
+	{
+		mIndexPool.Reset();
+		SnapshotHeader header;
+		if (!ReadSnapshotHeader<TComponent>(reader, schemaHash, header) || header.mCount >= size_t(INVALID_INDEX))
+		{
+			return false;
+		}
+		const T count = static_cast<T>(header.mCount);
+		ion::Vector<uint64_t> freeBits;
+		freeBits.Resize((size_t(count) + 63) / 64);
+		if (!ReadSnapshotArray(reader, freeBits.Data(), freeBits.Size()))
+		{
+			return false;
+		}
+		mIndexPool.Restore(count, freeBits.Data());
+		if (count > 0)
+		{
+			ResizeProtection(count - 1);
+		}
+		// All loaded components are changed
+		mChangeTicks.Clear();
+		mChangeTicks.Resize(NumChangeBlocks(count));
+		for (size_t i = 0; i < mChangeTicks.Size(); ++i)
+		{
+			mChangeTicks[i] = mTick;
+		}
+		return true;
+	}
+
+	[[nodiscard]] static constexpr size_t NumChangeBlocks(T max)
+	{
+		return (size_t(max) + (size_t(1) << ChangeBlockShift) - 1) >> ChangeBlockShift;
+	}
+
+	ion::Vector<uint32_t> mChangeTicks;
+	uint32_t mTick = 1;
 #if ION_COMPONENT_VERSION_NUMBER
 	ion::Vector<T> mVersions;
 #endif
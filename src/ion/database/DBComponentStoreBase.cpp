@@ -17,6 +17,35 @@
 
 ion::ComponentStoreBase::ComponentStoreBase() {}
 
+#if ION_COMPONENT_SUPPORT_CACHE_TRACKING
+namespace
+{
+ION_THREAD_LOCAL bool gIsCacheScopeActive = false;
+}
+
+ion::ComponentStoreBase::CacheScope::CacheScope(const ComponentStoreBase& store) : mStore(store), mIsStarted(false)
+{
+	if (!gIsCacheScopeActive && IsHardwareCacheTracking())
+	{
+		mIsStarted = ion::hardware_counters::Read(mStart);
+		gIsCacheScopeActive = mIsStarted;
+	}
+}
+
+ion::ComponentStoreBase::CacheScope::~CacheScope()
+{
+	if (mIsStarted)
+	{
+		gIsCacheScopeActive = false;
+		ion::hardware_counters::Sample end;
+		if (ion::hardware_counters::Read(end))
+		{
+			mStore.AddHardwareCacheStats(mStart, end);
+		}
+	}
+}
+#endif
+
 ion::ComponentStoreBase::~ComponentStoreBase()
 {
 #if ION_COMPONENT_SUPPORT_CACHE_TRACKING
@@ -54,6 +83,23 @@ ion::ComponentStoreBase::~ComponentStoreBase()
 		}
 	}
 
+	if (const uint64_t numScopes = mNumHardwareScopes.load())
+	{
+		ION_LOG_INFO("Store '" << mName.CStr() << "' hardware counters over " << numScopes << " scopes:");
+		for (uint32_t i = 0; i < ion::hardware_counters::NumCounters; i++)
+		{
+			const auto counter = ion::hardware_counters::Counter(i);
+			if (ion::hardware_counters::IsAvailable(counter))
+			{
+				ION_LOG_INFO("\t" << ion::hardware_counters::Name(counter) << ": " << mHardwareCounters[i].load() << " ("
+								   << static_cast<double>(mHardwareCounters[i].load()) / numScopes << " per scope)");
+			}
+			else
+			{
+				ION_LOG_INFO("\t" << ion::hardware_counters::Name(counter) << ": not available");
+			}
+		}
+	}
 #endif
 #if ION_COMPONENT_READ_WRITE_CHECKS
 	ION_CHECK(mStoreGuard.IsFree(), "Store deleted when in use");
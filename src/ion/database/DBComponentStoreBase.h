@@ -25,6 +25,8 @@
 #if ION_COMPONENT_SUPPORT_CACHE_TRACKING
 	#include <ion/string/String.h>
 	#include <ion/jobs/ThreadPool.h>
+	#include <ion/debug/HardwareCounters.h>
+	#include <atomic>
 #endif
 
 namespace ion
@@ -48,10 +50,42 @@ public:
 	void TrackCache(size_t callIndex, const T* const anAddress, bool isWriting = false) const
 	{
 #if ION_COMPONENT_SUPPORT_CACHE_TRACKING
-		TrackCache(callIndex, anAddress, sizeof(T), isWriting);
+		if (!IsHardwareCacheTracking())
+		{
+			TrackCache(callIndex, anAddress, sizeof(T), isWriting);
+		}
 #endif
 	}
 
+	// Store access scope. With hardware cache tracking, cache misses of the calling thread during scope are counted for the
+	// store. Counters are read when scope opens and closes, thus open scope around a batch of accesses, e.g. a job of a
+	// parallel loop, rather than around each component access. Nested scopes are counted for the outermost scope of the
+	// thread only.
+	class CacheScope
+	{
+	public:
+#if ION_COMPONENT_SUPPORT_CACHE_TRACKING
+		CacheScope(const ComponentStoreBase& store);
+
+		~CacheScope();
+
+	private:
+		const ComponentStoreBase& mStore;
+		ion::hardware_counters::Sample mStart;
+		bool mIsStarted;
+#else
+		CacheScope(const ComponentStoreBase&) {}
+#endif
+	};
+
+#if ION_COMPONENT_SUPPORT_CACHE_TRACKING
+	// Hardware counters are used when cache tracking mode is 2 and perf events are available, otherwise cache is simulated
+	[[nodiscard]] static bool IsHardwareCacheTracking()
+	{
+		return ION_COMPONENT_SUPPORT_CACHE_TRACKING == 2 && ion::hardware_counters::IsAvailable();
+	}
+#endif
+
 protected:
 #if ION_COMPONENT_SUPPORT_CACHE_TRACKING
 	void SetName(const char* name) { mName = name; }
@@ -94,10 +128,25 @@ protected:
 
 	// Stats per thread
 	mutable ion::Vector<Stats> mStats;
+
+	// Hardware counter totals of all threads
+	mutable std::atomic<uint64_t> mHardwareCounters[ion::hardware_counters::NumCounters] = {};
+	mutable std::atomic<uint64_t> mNumHardwareScopes = 0;
 #endif
 private:
 #if ION_COMPONENT_SUPPORT_CACHE_TRACKING
 	void TrackCache(size_t callIndex, const void* const anAddress, size_t sizeOfT, bool isWriting) const;
+
+	void AddHardwareCacheStats(const ion::hardware_counters::Sample& start, const ion::hardware_counters::Sample& end) const
+	{
+		uint64_t values[ion::hardware_counters::NumCounters];
+		ion::hardware_counters::Elapsed(start, end, values);
+		for (uint32_t i = 0; i < ion::hardware_counters::NumCounters; ++i)
+		{
+			mHardwareCounters[i].fetch_add(values[i], std::memory_order_relaxed);
+		}
+		mNumHardwareScopes.fetch_add(1, std::memory_order_relaxed);
+	}
 #endif
 };
 }  // namespace ion
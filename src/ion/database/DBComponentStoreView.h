@@ -24,7 +24,7 @@ protected:
 	T& mStore;
 	const typename T::Index mIndex;
 
-	constexpr ComponentStoreView(T& aStore, const typename T::Index anIndex) : mStore(aStore), mIndex(anIndex)
+	ComponentStoreView(T& aStore, const typename T::Index anIndex) : mStore(aStore), mIndex(anIndex)
 	{
 		ION_ASSERT_FMT_IMMEDIATE(anIndex != ~static_cast<typename T::Index>(0), "Invalid component");
 		mStore.OnCreated(mIndex);
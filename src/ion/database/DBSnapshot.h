@@ -0,0 +1,147 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <ion/byte/ByteReader.h>
+#include <ion/byte/ByteWriter.h>
+#include <ion/tracing/Log.h>
+#include <ion/util/Hasher.h>
+
+#include <limits>
+#include <type_traits>
+
+// Binary snapshots of component data.
+//
+// Snapshot is a header followed by arrays written with a single bulk copy each. Arrays are padded to multiple of
+// SnapshotAlignment bytes, thus when snapshot starts at aligned address, e.g. in memory mapped file, arrays can be used in
+// place. Data is in host byte order, snapshots are meant for checkpointing on the same platform, not for persistent storage.
+namespace ion
+{
+constexpr size_t SnapshotAlignment = 8;
+
+struct SnapshotHeader
+{
+	static constexpr uint32_t Magic = 0x50414E53;  // "SNAP"
+	static constexpr uint32_t Version = 1;
+
+	uint32_t mMagic;
+	uint32_t mVersion;
+	uint64_t mSchemaHash;	// Hash of user schema id and layout of stored types
+	uint64_t mCount;		// Number of items
+	uint64_t mDataBytes;	// Size of item array in bytes
+};
+static_assert(sizeof(SnapshotHeader) % SnapshotAlignment == 0);
+
+// Combines user schema id with layout of stored type, so that snapshot is not restored to a different type layout
+template <typename T>
+[[nodiscard]] inline uint64_t SnapshotSchemaHash(uint64_t schemaId)
+{
+	const uint64_t layout[] = {schemaId, sizeof(T), alignof(T)};
+	return ion::HashMemory64(layout, sizeof(layout));
+}
+
+template <typename T>
+inline void WriteSnapshotHeader(ion::ByteWriter& writer, uint64_t schemaHash, size_t count)
+{
+	SnapshotHeader header;
+	header.mMagic = SnapshotHeader::Magic;
+	header.mVersion = SnapshotHeader::Version;
+	header.mSchemaHash = SnapshotSchemaHash<T>(schemaHash);
+	header.mCount = count;
+	header.mDataBytes = count * sizeof(T);
+	writer.Write(header);
+}
+
+// Returns false if header is missing or snapshot was written with different schema or type layout
+template <typename T>
+[[nodiscard]] inline bool ReadSnapshotHeader(ion::ByteReader& reader, uint64_t schemaHash, SnapshotHeader& header)
+{
+	if (!reader.Read(header))
+	{
+		return false;
+	}
+	if (header.mMagic != SnapshotHeader::Magic || header.mVersion != SnapshotHeader::Version)
+	{
+		ION_WRN("Invalid snapshot header");
+		return false;
+	}
+	if (header.mSchemaHash != SnapshotSchemaHash<T>(schemaHash) || header.mDataBytes != header.mCount * sizeof(T))
+	{
+		ION_WRN("Snapshot schema mismatch");
+		return false;
+	}
+	return true;
+}
+
+namespace detail
+{
+[[nodiscard]] constexpr size_t SnapshotPadding(size_t numBytes)
+{
+	return (SnapshotAlignment - (numBytes % SnapshotAlignment)) % SnapshotAlignment;
+}
+}  // namespace detail
+
+template <typename T>
+inline void WriteSnapshotArray(ion::ByteWriter& writer, const T* data, size_t count)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Snapshot requires trivially copyable data");
+	const size_t numBytes = count * sizeof(T);
+	ION_ASSERT(numBytes <= (std::numeric_limits<ByteSizeType>::max)(), "Snapshot array too large");
+	if (numBytes > 0)
+	{
+		writer.WriteArray(reinterpret_cast<const u8*>(data), ByteSizeType(numBytes));
+	}
+	const u8 padding[SnapshotAlignment] = {};
+	if (const size_t numPadding = detail::SnapshotPadding(numBytes))
+	{
+		writer.WriteArray(padding, ByteSizeType(numPadding));
+	}
+}
+
+// Copies array to destination
+template <typename T>
+[[nodiscard]] inline bool ReadSnapshotArray(ion::ByteReader& reader, T* data, size_t count)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Snapshot requires trivially copyable data");
+	const size_t numBytes = count * sizeof(T);
+	const size_t numPadding = detail::SnapshotPadding(numBytes);
+	if (reader.Available() < numBytes + numPadding)
+	{
+		return false;
+	}
+	if (numBytes > 0)
+	{
+		reader.ReadAssumeAvailable(reinterpret_cast<u8*>(data), ByteSizeType(numBytes));
+	}
+	reader.SkipBytes(ByteSizeType(numPadding));
+	return true;
+}
+
+// Returns pointer to array in reader's buffer without copying, or nullptr if data is not available or not aligned for T.
+template <typename T>
+[[nodiscard]] inline const T* ViewSnapshotArray(ion::ByteReader& reader, size_t count)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Snapshot requires trivially copyable data");
+	const size_t numBytes = count * sizeof(T);
+	const size_t numPadding = detail::SnapshotPadding(numBytes);
+	if (reader.Available() < numBytes + numPadding || reinterpret_cast<uintptr_t>(reader.Data()) % alignof(T) != 0)
+	{
+		return nullptr;
+	}
+	const T* data = reinterpret_cast<const T*>(reader.Data());
+	reader.SkipBytes(ByteSizeType(numBytes + numPadding));
+	return data;
+}
+}  // namespace ion
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <ion/container/Vector.h>
+#include <ion/database/DBArchetypeStore.h>
+#include <ion/debug/Profiling.h>
+#include <ion/jobs/JobScheduler.h>
+#include <ion/util/InplaceFunction.h>
+
+#include <atomic>
+
+namespace ion
+{
+// Data accessed by a system. Accessed types are identified by GetComponentTypeId<T>(), thus they can be archetype components
+// or other shared data, e.g. component stores of Admin.
+struct SystemAccess
+{
+	// Const types are read and other types are written
+	template <typename... Ts>
+	[[nodiscard]] static SystemAccess Of()
+	{
+		SystemAccess access;
+		(access.Add<Ts>(), ...);
+		return access;
+	}
+
+	template <typename T>
+	SystemAccess& Add()
+	{
+		if constexpr (std::is_const_v<T>)
+		{
+			mRead.Set(GetComponentTypeId<std::remove_const_t<T>>());
+		}
+		else
+		{
+			mWrite.Set(GetComponentTypeId<T>());
+		}
+		return *this;
+	}
+
+	// Creating or destroying entities or adding or removing components moves components of other entities, thus structural
+	// changes conflict with all other systems.
+	SystemAccess& Structural()
+	{
+		mIsStructural = true;
+		return *this;
+	}
+
+	[[nodiscard]] bool ConflictsWith(const SystemAccess& other) const
+	{
+		return mIsStructural || other.mIsStructural || mWrite.Intersects(other.mWrite) || mWrite.Intersects(other.mRead) ||
+			   other.mWrite.Intersects(mRead);
+	}
+
+	ComponentMask mRead;
+	ComponentMask mWrite;
+	bool mIsStructural = false;
+};
+
+// Runs systems once per tick using job scheduler.
+//
+// Systems have the same effect as if they were run in the order they were added, but systems that do not have conflicting
+// access are run in parallel. Dependency graph is rebuilt when systems are added: each system depends on the earlier systems
+// that have conflicting access. On run, a system is started as soon as all systems it depends on have finished, there are no
+// barriers between unrelated systems. Systems can further split their queries to jobs using e.g.
+// ArchetypeStore::ParallelForEach().
+//
+// Systems are also grouped to stages for inspection: each system is in the stage after the last stage that has a system it
+// depends on.
+template <typename TContext>
+class SystemScheduler
+{
+public:
+	using Function = ion::InplaceFunction<void(TContext&, ion::JobScheduler&)>;
+	using SystemId = uint32_t;
+
+	SystemId Add(const char* name, const SystemAccess& access, Function&& function)
+	{
+		mSystems.Add(System{name, access, std::move(function)});
+		mIsScheduleValid = false;
+		return SystemId(mSystems.Size() - 1);
+	}
+
+	void Clear()
+	{
+		mSystems.Clear();
+		mIsScheduleValid = false;
+	}
+
+	[[nodiscard]] size_t NumSystems() const { return mSystems.Size(); }
+
+	[[nodiscard]] const char* Name(SystemId id) const { return mSystems[id].mName; }
+
+	[[nodiscard]] const SystemAccess& Access(SystemId id) const { return mSystems[id].mAccess; }
+
+	[[nodiscard]] bool CanRunInParallel(SystemId a, SystemId b) const
+	{
+		return !mSystems[a].mAccess.ConflictsWith(mSystems[b].mAccess);
+	}
+
+	// Number of stages, i.e. length of the longest chain of dependent systems
+	[[nodiscard]] size_t NumStages()
+	{
+		BuildSchedule();
+		return mStageEnds.Size();
+	}
+
+	// Calls callback(SystemId) for systems of stage
+	template <typename Callback>
+	void ForEachSystemInStage(size_t stage, Callback&& callback)
+	{
+		BuildSchedule();
+		for (uint32_t i = stage == 0 ? 0 : mStageEnds[stage - 1]; i < mStageEnds[stage]; ++i)
+		{
+			callback(mOrder[i]);
+		}
+	}
+
+	void Run(TContext& context, ion::JobScheduler& js)
+	{
+		ION_PROFILER_SCOPE(Job, "Systems");
+		BuildSchedule();
+		if (mRoots.IsEmpty())
+		{
+			return;
+		}
+		for (size_t i = 0; i < mSystems.Size(); ++i)
+		{
+			mNumPending[i] = mNumPredecessors[i];
+		}
+		RunSystems(mRoots.Begin(), mRoots.End(), context, js);
+	}
+
+private:
+	struct System
+	{
+		const char* mName;
+		SystemAccess mAccess;
+		Function mFunction;
+	};
+
+	void RunSystem(SystemId id, TContext& context, ion::JobScheduler& js)
+	{
+		ION_PROFILER_SCOPE_DETAIL(Job, "System", size_t(id));
+		mSystems[id].mFunction(context, js);
+	}
+
+	void RunSystems(SystemId* first, SystemId* last, TContext& context, ion::JobScheduler& js)
+	{
+		if (last - first == 1)
+		{
+			RunChain(*first, context, js);
+		}
+		else
+		{
+			js.ParallelFor(first, last, 1u, 1u, [&](SystemId& id) { RunChain(id, context, js); });
+		}
+	}
+
+	// Runs system and then the successors it makes ready. The last finished dependency starts the successor, thus every
+	// system is run exactly once and only after its own dependencies.
+	void RunChain(SystemId id, TContext& context, ion::JobScheduler& js)
+	{
+		for (;;)
+		{
+			RunSystem(id, context, js);
+			ion::SmallVector<SystemId, 16> ready;
+			for (uint32_t i = mSuccessorOffsets[id]; i < mSuccessorOffsets[id + 1]; ++i)
+			{
+				const SystemId successor = mSuccessors[i];
+				if (std::atomic_ref<uint32_t>(mNumPending[successor]).fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					ready.Add(successor);
+				}
+			}
+			if (ready.Size() != 1)
+			{
+				if (!ready.IsEmpty())
+				{
+					RunSystems(ready.Begin(), ready.End(), context, js);
+				}
+				return;
+			}
+			id = ready[0];
+		}
+	}
+
+	void BuildSchedule()
+	{
+		if (mIsScheduleValid)
+		{
+			return;
+		}
+		mIsScheduleValid = true;
+
+		const size_t numSystems = mSystems.Size();
+		ion::Vector<uint32_t> stages;
+		stages.Resize(numSystems);
+		mNumPredecessors.Clear();
+		mNumPredecessors.Resize(numSystems);
+		mNumPending.Resize(numSystems);
+		mSuccessorOffsets.Clear();
+		mSuccessorOffsets.Resize(numSystems + 1);
+		mSuccessors.Clear();
+		mRoots.Clear();
+		uint32_t numStages = 0;
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			uint32_t stage = 0;
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (mSystems[i].mAccess.ConflictsWith(mSystems[j].mAccess))
+				{
+					stage = ion::Max(stage, stages[j] + 1);
+					mNumPredecessors[i]++;
+					mSuccessorOffsets[j + 1]++;
+				}
+			}
+			stages[i] = stage;
+			numStages = ion::Max(numStages, stage + 1);
+			if (mNumPredecessors[i] == 0)
+			{
+				mRoots.Add(SystemId(i));
+			}
+		}
+
+		// Successors of each system in order, offsets are prefix sums of successor counts
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			mSuccessorOffsets[i + 1] += mSuccessorOffsets[i];
+		}
+		mSuccessors.Resize(mSuccessorOffsets[numSystems]);
+		ion::Vector<uint32_t> writePos;
+		writePos.Resize(numSystems);
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			writePos[i] = mSuccessorOffsets[i];
+		}
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			for (size_t j = 0; j < i; ++j)
+			{
+				if (mSystems[i].mAccess.ConflictsWith(mSystems[j].mAccess))
+				{
+					mSuccessors[writePos[j]++] = SystemId(i);
+				}
+			}
+		}
+
+		// Counting sort by stage keeps order of systems within stage
+		mStageEnds.Clear();
+		mStageEnds.Resize(numStages);
+		for (size_t i = 0; i < numSystems; ++i)
+		{
+			mStageEnds[stages[i]]++;
+		}
+		uint32_t end = 0;
+		for (uint32_t stage = 0; stage < numStages; ++stage)
+		{
+			end += mStageEnds[stage];
+			mStageEnds[stage] = end;
+		}
+		mOrder.Resize(numSystems);
+		for (size_t i = numSystems; i-- > 0;)
+		{
+			mOrder[--mStageEnds[stages[i]]] = SystemId(i);
+		}
+		for (uint32_t stage = 0; stage < numStages; ++stage)
+		{
+			mStageEnds[stage] = stage + 1 < numStages ? mStageEnds[stage + 1] : uint32_t(numSystems);
+		}
+	}
+
+	ion::Vector<System> mSystems;
+	ion::Vector<SystemId> mOrder;		// Systems sorted by stage
+	ion::Vector<uint32_t> mStageEnds;	// End of each stage in mOrder
+	ion::Vector<uint32_t> mNumPredecessors;
+	ion::Vector<uint32_t> mNumPending;			// Dependencies not finished during run, accessed atomically
+	ion::Vector<uint32_t> mSuccessorOffsets;	// Range of successors of each system in mSuccessors
+	ion::Vector<SystemId> mSuccessors;
+	ion::Vector<SystemId> mRoots;				// Systems without dependencies
+	bool mIsScheduleValid = true;
+};
+}  // namespace ion
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ion/debug/HardwareCounters.h>
+
+#include <atomic>
+
+#if ION_PLATFORM_LINUX
+	#include <linux/perf_event.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+namespace ion
+{
+namespace hardware_counters
+{
+namespace
+{
+// -1: not probed, 0: not available, otherwise 1 + mask of available counters
+std::atomic<int> gAvailability = -1;
+
+#if ION_PLATFORM_LINUX
+constexpr int NotOpened = -2;
+constexpr int OpenFailed = -1;  // Also used as group fd of group leader
+
+// Counters are read as a group through leader. Counters that failed to open are missing from the group. Counters are closed
+// when thread exits.
+struct ThreadCounters
+{
+	int mGroupFd = NotOpened;
+	uint32_t mCounterMask = 0;
+	int mFds[NumCounters] = {};
+
+	~ThreadCounters()
+	{
+		for (uint32_t i = 0; i < NumCounters; ++i)
+		{
+			if (mCounterMask & (1u << i))
+			{
+				close(mFds[i]);
+			}
+		}
+	}
+};
+thread_local ThreadCounters gThreadCounters;
+
+int OpenCounter(Counter counter, int groupFd)
+{
+	perf_event_attr attr = {};
+	attr.size = sizeof(attr);
+	switch (counter)
+	{
+	case L1DReadMisses:
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		break;
+	case LLCMisses:
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = PERF_COUNT_HW_CACHE_MISSES;
+		break;
+	case DTLBReadMisses:
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		break;
+	default:
+		return OpenFailed;
+	}
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	if (groupFd == OpenFailed)
+	{
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	}
+	return int(syscall(SYS_perf_event_open, &attr, 0 /* calling thread */, -1 /* any cpu */, groupFd, 0));
+}
+
+bool OpenThreadCounters()
+{
+	ThreadCounters& counters = gThreadCounters;
+	if (counters.mGroupFd != NotOpened)
+	{
+		return counters.mGroupFd >= 0;
+	}
+	counters.mGroupFd = OpenFailed;
+	counters.mCounterMask = 0;
+	for (uint32_t i = 0; i < NumCounters; ++i)
+	{
+		const int fd = OpenCounter(Counter(i), counters.mGroupFd);
+		if (fd >= 0)
+		{
+			counters.mFds[i] = fd;
+			counters.mCounterMask |= 1u << i;
+			if (counters.mGroupFd == OpenFailed)
+			{
+				counters.mGroupFd = fd;
+			}
+		}
+	}
+	// Counters are enabled when opened and stay open for lifetime of the thread
+	return counters.mGroupFd >= 0;
+}
+#endif
+}  // namespace
+
+bool IsAvailable()
+{
+	int availability = gAvailability.load(std::memory_order_relaxed);
+	if (availability == -1)
+	{
+#if ION_PLATFORM_LINUX
+		availability = OpenThreadCounters() ? int(1 + gThreadCounters.mCounterMask) : 0;
+#else
+		availability = 0;
+#endif
+		gAvailability.store(availability, std::memory_order_relaxed);
+	}
+	return availability != 0;
+}
+
+bool IsAvailable(Counter counter)
+{
+	return IsAvailable() && ((gAvailability.load(std::memory_order_relaxed) - 1) & (1 << counter)) != 0;
+}
+
+const char* Name(Counter counter)
+{
+	switch (counter)
+	{
+	case L1DReadMisses:
+		return "L1D read misses";
+	case LLCMisses:
+		return "LLC misses";
+	case DTLBReadMisses:
+		return "dTLB read misses";
+	default:
+		return "Unknown";
+	}
+}
+
+bool Read(Sample& sample)
+{
+#if ION_PLATFORM_LINUX
+	if (!IsAvailable() || !OpenThreadCounters())
+	{
+		return false;
+	}
+	// Number of counters, time enabled, time running, followed by values in order of opening
+	constexpr size_t NumHeaderValues = 3;
+	uint64_t values[NumHeaderValues + NumCounters];
+	const ThreadCounters& counters = gThreadCounters;
+	const ssize_t numBytes = read(counters.mGroupFd, values, sizeof(values));
+	if (numBytes < ssize_t(NumHeaderValues * sizeof(uint64_t)))
+	{
+		return false;
+	}
+	sample.mTimeEnabled = values[1];
+	sample.mTimeRunning = values[2];
+	uint64_t next = 0;
+	for (uint32_t i = 0; i < NumCounters; ++i)
+	{
+		sample.mValues[i] = (counters.mCounterMask & (1u << i)) && next < values[0] ? values[NumHeaderValues + next++] : 0;
+	}
+	return true;
+#else
+	(void)sample;
+	return false;
+#endif
+}
+
+void Elapsed(const Sample& start, const Sample& end, uint64_t (&values)[NumCounters])
+{
+	// Counters of a group are scheduled together, thus all share the same scale
+	const uint64_t enabled = end.mTimeEnabled - start.mTimeEnabled;
+	const uint64_t running = end.mTimeRunning - start.mTimeRunning;
+	const double scale = running != 0 ? double(enabled) / double(running) : 0.0;
+	for (uint32_t i = 0; i < NumCounters; ++i)
+	{
+		const uint64_t count = end.mValues[i] - start.mValues[i];
+		values[i] = running == enabled ? count : uint64_t(double(count) * scale);
+	}
+}
+}  // namespace hardware_counters
+}  // namespace ion
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/Types.h>
+
+namespace ion
+{
+// Hardware cache counters of the calling thread.
+//
+// Uses Linux perf events. Counters are opened per thread on first use and count user space events only. Reading counters is a
+// system call, thus counters should be sampled around batches of work rather than single accesses. Counters are not
+// available on other platforms or when perf events are not permitted, e.g. kernel.perf_event_paranoid is too high or
+// hypervisor does not expose counters. Individual counters may be missing on some CPUs, those read as zero.
+namespace hardware_counters
+{
+enum Counter : uint32_t
+{
+	L1DReadMisses,
+	LLCMisses,
+	DTLBReadMisses,
+	NumCounters
+};
+
+struct Sample
+{
+	uint64_t mValues[NumCounters] = {};
+	// Time counters were enabled and actually counting. These differ when kernel multiplexes counters.
+	uint64_t mTimeEnabled = 0;
+	uint64_t mTimeRunning = 0;
+};
+
+// Returns true if any counter can be opened. Result of the first call is cached.
+[[nodiscard]] bool IsAvailable();
+
+[[nodiscard]] bool IsAvailable(Counter counter);
+
+[[nodiscard]] const char* Name(Counter counter);
+
+// Reads counters of calling thread. Returns false if counters are not available for the thread.
+bool Read(Sample& sample);
+
+// Counts between samples of the same thread, scaled to estimate full counts when counters were multiplexed.
+void Elapsed(const Sample& start, const Sample& end, uint64_t (&values)[NumCounters]);
+}  // namespace hardware_counters
+}  // namespace ion
@@ -0,0 +1,471 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ion/debug/HeapProfiler.h>
+#if ION_HEAP_PROFILER
+	#include <ion/byte/ByteBuffer.h>
+	#include <ion/byte/ByteReader.h>
+	#include <ion/byte/ByteWriter.h>
+	#include <ion/concurrency/Mutex.h>
+	#include <ion/container/Array.h>
+	#include <ion/container/Sort.h>
+	#include <ion/container/UnorderedMap.h>
+	#include <ion/container/Vector.h>
+	#include <ion/filesystem/File.h>
+	#include <ion/memory/DebugAllocator.h>
+	#include <ion/string/StringFormatter.h>
+	#include <ion/string/StringView.h>
+	#include <ion/tracing/Log.h>
+	#include <ion/util/Hasher.h>
+
+	#include <cinttypes>
+	#include <cmath>
+	#include <cstdio>
+	#if ION_PLATFORM_MICROSOFT
+		#include <Windows.h>
+		#include <intrin.h>
+	#else
+		#include <unwind.h>
+	#endif
+
+namespace ion
+{
+namespace heap_profiler
+{
+namespace detail
+{
+ION_THREAD_LOCAL int64_t gBytesUntilSample = 0;
+std::atomic<uint16_t> gSampleFilter[SampleFilterSize] = {};
+}  // namespace detail
+
+namespace
+{
+constexpr size_t MaxFrames = 32;
+
+// Profiler frames are skipped by finding return address of the sampling hook, i.e. call site stack starts from the code that
+// called the hook, regardless of what was inlined
+	#if ION_COMPILER_MSVC
+		#define ION_HEAP_PROFILER_RETURN_ADDRESS() _ReturnAddress()
+	#else
+		#define ION_HEAP_PROFILER_RETURN_ADDRESS() __builtin_return_address(0)
+	#endif
+
+std::atomic<size_t> gSamplingInterval = DefaultSamplingInterval;
+
+ION_THREAD_LOCAL uint64_t gRandState = 0;
+ION_THREAD_LOCAL bool gIsInProfiler = false;
+ION_THREAD_LOCAL bool gIsSampleDistanceSet = false;  // gBytesUntilSample is zero until first allocation of thread
+
+struct CallStack
+{
+	ion::Array<void*, MaxFrames> mFrames;
+	uint32_t mNumFrames = 0;
+};
+
+	#if !ION_PLATFORM_MICROSOFT
+struct UnwindState
+{
+	CallStack* mStack;
+	void* mFirstFrame;	// Frames before this are dropped, null when found
+};
+
+_Unwind_Reason_Code UnwindCallback(struct _Unwind_Context* context, void* arg)
+{
+	UnwindState* state = reinterpret_cast<UnwindState*>(arg);
+	void* pc = reinterpret_cast<void*>(_Unwind_GetIP(context));
+	if (pc == nullptr)
+	{
+		return _URC_END_OF_STACK;
+	}
+	if (pc == state->mFirstFrame)
+	{
+		state->mStack->mNumFrames = 0;
+		state->mFirstFrame = nullptr;
+	}
+	if (state->mStack->mNumFrames < MaxFrames)
+	{
+		state->mStack->mFrames[state->mStack->mNumFrames++] = pc;
+	}
+	return state->mStack->mNumFrames == MaxFrames && state->mFirstFrame == nullptr ? _URC_END_OF_STACK : _URC_NO_REASON;
+}
+	#endif
+
+// Captures call stack starting from 'firstFrame'. If 'firstFrame' is not found, all frames are kept.
+void CaptureCallStack(CallStack& stack, void* firstFrame)
+{
+	#if ION_PLATFORM_MICROSOFT
+	constexpr size_t MaxProfilerFrames = 8;
+	void* frames[MaxFrames + MaxProfilerFrames];
+	const size_t numFrames = CaptureStackBackTrace(0, DWORD(MaxFrames + MaxProfilerFrames), frames, nullptr);
+	size_t first = 0;
+	while (first < numFrames && frames[first] != firstFrame)
+	{
+		first++;
+	}
+	first = first < numFrames ? first : 0;
+	stack.mNumFrames = uint32_t(ion::Min(numFrames - first, MaxFrames));
+	memcpy(stack.mFrames.Data(), &frames[first], stack.mNumFrames * sizeof(void*));
+	#else
+	UnwindState state{&stack, firstFrame};
+	_Unwind_Backtrace(UnwindCallback, &state);
+	#endif
+}
+
+uint64_t NextRandom()
+{
+	if (gRandState == 0)
+	{
+		gRandState = reinterpret_cast<uintptr_t>(&gRandState) ^ 0x9E3779B97F4A7C15ull;
+	}
+	// XorShift64*
+	gRandState ^= gRandState >> 12;
+	gRandState ^= gRandState << 25;
+	gRandState ^= gRandState >> 27;
+	return gRandState * 0x2545F4914F6CDD1Dull;
+}
+
+// Exponentially distributed distance to next sample makes sampling a Poisson process, i.e. each allocated byte has equal
+// probability to be sampled regardless of allocation pattern.
+int64_t NextSampleDistance()
+{
+	size_t interval = gSamplingInterval.load(std::memory_order_relaxed);
+	if (interval == 0)
+	{
+		return INT64_MAX;
+	}
+	double u = double((NextRandom() >> 11) + 1) * (1.0 / 9007199254740992.0);	// (0, 1]
+	return int64_t(-std::log(u) * double(interval)) + 1;
+}
+
+// Sampled counts are written to pprof, which unsamples them using sampling interval. Estimated counts are scaled by inverse
+// sampling probability for in-process stats.
+struct Site
+{
+	CallStack mStack;
+	MemTag mTag;
+	uint64_t mLiveBytes = 0;
+	uint64_t mLiveCount = 0;
+	uint64_t mAllocatedBytes = 0;
+	uint64_t mAllocatedCount = 0;
+	double mEstimatedLiveBytes = 0;
+	double mEstimatedLiveCount = 0;
+	double mEstimatedAllocatedBytes = 0;
+	double mEstimatedAllocatedCount = 0;
+};
+
+struct Sample
+{
+	uint32_t mSite;
+	size_t mBytes;
+	double mEstimatedCount;
+};
+
+template <typename T>
+using ProfilerAllocator = ion::DebugAllocator<T>;
+
+struct HeapProfiler
+{
+	ion::Mutex mMutex;
+	ion::Vector<Site, ProfilerAllocator<Site>> mSites;
+	ion::UnorderedMap<uint64_t, uint32_t, ion::Hasher<uint64_t>, ProfilerAllocator<ion::Pair<uint64_t const, uint32_t>>> mSiteLookup;
+	ion::UnorderedMap<uint64_t, Sample, ion::Hasher<uint64_t>, ProfilerAllocator<ion::Pair<uint64_t const, Sample>>> mSamples;
+	size_t mSamplingInterval = DefaultSamplingInterval;
+
+	uint32_t FindOrAddSite(const CallStack& stack, MemTag tag)
+	{
+		uint64_t key = ion::HashMemory64(stack.mFrames.Data(), stack.mNumFrames * sizeof(void*), tag);
+		auto iter = mSiteLookup.Find(key);
+		if (iter != mSiteLookup.End())
+		{
+			return iter->second;
+		}
+		uint32_t index = uint32_t(mSites.Size());
+		mSites.Add(Site{stack, tag});
+		mSiteLookup.Insert(key, index);
+		return index;
+	}
+
+	void Add(void* ptr, size_t size, const CallStack& stack, MemTag tag)
+	{
+		// Allocation of 'size' bytes is sampled with probability 1-exp(-size/interval), scale by inverse probability
+		double interval = double(ion::Max(mSamplingInterval, size_t(1)));
+		double probability = 1.0 - std::exp(-double(size) / interval);
+		double count = probability > 0 ? 1.0 / probability : 1.0;
+
+		ion::AutoLock<ion::Mutex> lock(mMutex);
+		uint32_t siteIndex = FindOrAddSite(stack, tag);
+		Site& site = mSites[siteIndex];
+		site.mLiveBytes += size;
+		site.mLiveCount++;
+		site.mAllocatedBytes += size;
+		site.mAllocatedCount++;
+		site.mEstimatedLiveBytes += double(size) * count;
+		site.mEstimatedLiveCount += count;
+		site.mEstimatedAllocatedBytes += double(size) * count;
+		site.mEstimatedAllocatedCount += count;
+		if (mSamples.TryInsert({reinterpret_cast<uintptr_t>(ptr), Sample{siteIndex, size, count}}).second)
+		{
+			detail::gSampleFilter[detail::SampleFilterIndex(ptr)]++;
+		}
+	}
+
+	void Remove(void* ptr)
+	{
+		ion::AutoLock<ion::Mutex> lock(mMutex);
+		auto iter = mSamples.Find(reinterpret_cast<uintptr_t>(ptr));
+		if (iter != mSamples.End())
+		{
+			const Sample& sample = iter->second;
+			Site& site = mSites[sample.mSite];
+			site.mLiveBytes -= sample.mBytes;
+			site.mLiveCount--;
+			site.mEstimatedLiveBytes -= double(sample.mBytes) * sample.mEstimatedCount;
+			site.mEstimatedLiveCount -= sample.mEstimatedCount;
+			mSamples.Erase(iter);
+			detail::gSampleFilter[detail::SampleFilterIndex(ptr)]--;
+		}
+	}
+};
+
+std::atomic<HeapProfiler*> gProfiler = nullptr;
+
+HeapProfiler& Profiler()
+{
+	HeapProfiler* profiler = gProfiler.load(std::memory_order_acquire);
+	if (profiler == nullptr)
+	{
+		// Profiler is never freed as there can be sampled allocations alive until the very end
+		HeapProfiler* candidate = new (ion::detail::NativeMalloc(sizeof(HeapProfiler))) HeapProfiler();
+		if (gProfiler.compare_exchange_strong(profiler, candidate))
+		{
+			profiler = candidate;
+		}
+		else
+		{
+			candidate->~HeapProfiler();
+			ion::detail::NativeFree(candidate);
+		}
+	}
+	return *profiler;
+}
+
+void AddLine(ion::ByteWriter& writer, ion::StackStringFormatter<256>& line)
+{
+	const char* str = line.CStr();
+	writer.WriteArray(reinterpret_cast<const u8*>(str), ByteSizeType(line.Length()));
+}
+
+void CopySites(ion::Vector<Site, ProfilerAllocator<Site>>& out, size_t& interval)
+{
+	ion::AutoLock<ion::Mutex> lock(Profiler().mMutex);
+	out.Reserve(Profiler().mSites.Size());
+	for (size_t i = 0; i < Profiler().mSites.Size(); ++i)
+	{
+		out.Add(Profiler().mSites[i]);
+	}
+	interval = Profiler().mSamplingInterval;
+}
+}  // namespace
+
+namespace detail
+{
+void OnSampledAllocation(void* ptr, size_t size)
+{
+	if (!gIsSampleDistanceSet)
+	{
+		// First allocation of thread is sampled only if it reaches the initial distance, not to bias toward thread startup
+		gIsSampleDistanceSet = true;
+		gBytesUntilSample = NextSampleDistance() - static_cast<int64_t>(size);
+		if (gBytesUntilSample > 0)
+		{
+			return;
+		}
+	}
+	gBytesUntilSample = NextSampleDistance();
+	if (ptr == nullptr || gIsInProfiler)
+	{
+		return;
+	}
+	gIsInProfiler = true;
+	CallStack stack;
+	CaptureCallStack(stack, ION_HEAP_PROFILER_RETURN_ADDRESS());
+	Profiler().Add(ptr, size, stack, ion::detail::GetMemoryTag());
+	gIsInProfiler = false;
+}
+
+void OnSampledDeallocation(void* ptr)
+{
+	if (gIsInProfiler)
+	{
+		return;
+	}
+	gIsInProfiler = true;
+	Profiler().Remove(ptr);
+	gIsInProfiler = false;
+}
+}  // namespace detail
+
+void SetSamplingInterval(size_t bytes)
+{
+	{
+		ion::AutoLock<ion::Mutex> lock(Profiler().mMutex);
+		Profiler().mSamplingInterval = bytes;
+	}
+	gSamplingInterval = bytes;
+	detail::gBytesUntilSample = NextSampleDistance();
+	gIsSampleDistanceSet = true;
+}
+
+size_t SamplingInterval() { return gSamplingInterval; }
+
+void Stats(TagStats* stats)
+{
+	for (size_t i = 0; i <= tag::Count; ++i)
+	{
+		stats[i] = TagStats();
+	}
+	ion::AutoLock<ion::Mutex> lock(Profiler().mMutex);
+	for (size_t i = 0; i < Profiler().mSites.Size(); ++i)
+	{
+		const Site& site = Profiler().mSites[i];
+		auto AddSite = [&site](TagStats& tagStats)
+		{
+			tagStats.mLiveBytes += int64_t(site.mEstimatedLiveBytes);
+			tagStats.mLiveCount += int64_t(site.mEstimatedLiveCount);
+			tagStats.mAllocatedBytes += uint64_t(site.mEstimatedAllocatedBytes);
+			tagStats.mAllocatedCount += uint64_t(site.mEstimatedAllocatedCount);
+		};
+		AddSite(stats[ion::Min(site.mTag, tag::Count)]);
+		AddSite(stats[tag::Count]);
+	}
+}
+
+void PrintStats()
+{
+	ion::Array<TagStats, tag::Count + 1> stats;
+	Stats(stats.Data());
+	for (MemTag i = 0; i <= tag::Count; ++i)
+	{
+		if (stats[i].mAllocatedCount > 0)
+		{
+			ION_LOG_INFO_FMT("Heap[%s] ~%" PRId64 " bytes live (~%" PRId64 " blocks); ~%" PRIu64 " bytes allocated (~%" PRIu64 " blocks)",
+							 ion::tag::Name(i), stats[i].mLiveBytes, stats[i].mLiveCount, stats[i].mAllocatedBytes,
+							 stats[i].mAllocatedCount);
+		}
+	}
+}
+
+void Save(ByteBufferBase& buffer)
+{
+	ION_MEMORY_SCOPE(ion::tag::Profiling);
+	ion::Vector<Site, ProfilerAllocator<Site>> sites;
+	size_t interval;
+	CopySites(sites, interval);
+	ion::Sort(sites.Begin(), sites.End(),
+			  [](const Site& a, const Site& b)
+			  {
+				  if (a.mLiveBytes != b.mLiveBytes)
+				  {
+					  return a.mLiveBytes > b.mLiveBytes;
+				  }
+				  return a.mAllocatedBytes > b.mAllocatedBytes;
+			  });
+
+	Site total{};
+	for (const Site& site : sites)
+	{
+		total.mLiveBytes += site.mLiveBytes;
+		total.mLiveCount += site.mLiveCount;
+		total.mAllocatedBytes += site.mAllocatedBytes;
+		total.mAllocatedCount += site.mAllocatedCount;
+	}
+
+	ion::ByteWriter writer(buffer);
+	{
+		ion::StackStringFormatter<256> line;
+		line.Format("heap profile: %" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64 "] @ heap_v2/%zu\n", total.mLiveCount,
+					total.mLiveBytes, total.mAllocatedCount, total.mAllocatedBytes, interval);
+		AddLine(writer, line);
+	}
+	for (const Site& site : sites)
+	{
+		{
+			ion::StackStringFormatter<256> line;
+			line.Format("%" PRIu64 ": %" PRIu64 " [%" PRIu64 ": %" PRIu64 "] @", site.mLiveCount, site.mLiveBytes,
+						site.mAllocatedCount, site.mAllocatedBytes);
+			AddLine(writer, line);
+		}
+		for (uint32_t i = 0; i < site.mStack.mNumFrames; ++i)
+		{
+			ion::StackStringFormatter<256> line;
+			line.Format(" %p", site.mStack.mFrames[i]);
+			AddLine(writer, line);
+		}
+		{
+			// Memory tag is written as an extra frame comment, pprof ignores it, but it keeps the tag visible in diffs.
+			ion::StackStringFormatter<256> line;
+			line.Format(" # %s\n", ion::tag::Name(site.mTag));
+			AddLine(writer, line);
+		}
+	}
+
+	#if ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	{
+		ion::StackStringFormatter<256> line;
+		line.Format("\nMAPPED_LIBRARIES:\n");
+		AddLine(writer, line);
+	}
+	if (FILE* maps = fopen("/proc/self/maps", "r"))
+	{
+		char data[4096];
+		size_t len;
+		while ((len = fread(data, 1, sizeof(data), maps)) > 0)
+		{
+			writer.WriteArray(reinterpret_cast<const u8*>(data), ByteSizeType(len));
+		}
+		fclose(maps);
+	}
+	#endif
+}
+
+void Save(const char* filename)
+{
+	ION_MEMORY_SCOPE(ion::tag::Profiling);
+	ion::ByteBuffer<> buffer(32 * 1024);
+	Save(buffer);
+	ion::ByteReader reader(buffer);
+	ION_LOG_INFO_FMT("Writing heap profile to %s.", filename);
+	ion::file_util::ReplaceTargetFile(filename, reader);
+}
+
+}  // namespace heap_profiler
+}  // namespace ion
+#else
+namespace ion::heap_profiler
+{
+void SetSamplingInterval(size_t) {}
+size_t SamplingInterval() { return 0; }
+void Stats(TagStats* stats)
+{
+	for (size_t i = 0; i <= tag::Count; ++i)
+	{
+		stats[i] = TagStats();
+	}
+}
+void PrintStats() {}
+void Save(ByteBufferBase&) {}
+void Save(const char*) {}
+}  // namespace ion::heap_profiler
+#endif
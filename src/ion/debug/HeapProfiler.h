@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/memory/Memory.h>
+
+#if ION_HEAP_PROFILER
+	#include <atomic>
+#endif
+
+namespace ion
+{
+class ByteBufferBase;
+
+// Sampling heap profiler.
+//
+// Allocations are sampled on average once per 'SamplingInterval()' allocated bytes. Call stack and memory tag of each sampled
+// allocation are recorded and allocation sites are tracked for live memory (allocated, but not freed) and for churn (total
+// allocated). Stats() scales sample counts to estimate actual usage. Non-sampled allocations only decrement a thread local
+// counter and deallocations only check a small filter table, thus profiler does not add any per-block metadata.
+namespace heap_profiler
+{
+constexpr size_t DefaultSamplingInterval = 512 * 1024;
+
+struct TagStats
+{
+	int64_t mLiveBytes = 0;
+	int64_t mLiveCount = 0;
+	uint64_t mAllocatedBytes = 0;
+	uint64_t mAllocatedCount = 0;
+};
+
+#if ION_HEAP_PROFILER
+namespace detail
+{
+extern ION_THREAD_LOCAL int64_t gBytesUntilSample;
+
+// Number of live samples per address hash. Deallocation needs to look up samples only when counter is non-zero.
+constexpr size_t SampleFilterSize = 4096;
+extern std::atomic<uint16_t> gSampleFilter[SampleFilterSize];
+
+inline size_t SampleFilterIndex(const void* ptr) { return (reinterpret_cast<uintptr_t>(ptr) >> 4) & (SampleFilterSize - 1); }
+
+ION_NO_INLINE void OnSampledAllocation(void* ptr, size_t size);
+
+ION_NO_INLINE void OnSampledDeallocation(void* ptr);
+}  // namespace detail
+
+inline void OnAllocation(void* ptr, size_t size)
+{
+	detail::gBytesUntilSample -= static_cast<int64_t>(size);
+	if ION_UNLIKELY (detail::gBytesUntilSample <= 0)
+	{
+		detail::OnSampledAllocation(ptr, size);
+	}
+}
+
+inline void OnDeallocation(void* ptr)
+{
+	if ION_UNLIKELY (detail::gSampleFilter[detail::SampleFilterIndex(ptr)].load(std::memory_order_relaxed) != 0)
+	{
+		detail::OnSampledDeallocation(ptr);
+	}
+}
+#else
+inline void OnAllocation(void*, size_t) {}
+
+inline void OnDeallocation(void*) {}
+#endif
+
+// Sets average number of allocated bytes between samples. Zero disables sampling.
+void SetSamplingInterval(size_t bytes);
+
+size_t SamplingInterval();
+
+// Estimated memory usage. 'stats' must have room for tag::Count + 1 entries, last entry will contain total of all tags.
+void Stats(TagStats* stats);
+
+void PrintStats();
+
+// Writes allocation sites in pprof legacy heap profile text format. Sampled counts are written unscaled, pprof unsamples them
+// using the sampling interval in the header. Sites are ordered by live bytes. On Linux and Android
+// mapped libraries are appended for symbolization.
+void Save(ByteBufferBase& buffer);
+
+void Save(const char* filename);
+
+}  // namespace heap_profiler
+}  // namespace ion
@@ -16,6 +16,9 @@
 #pragma once
 #include <ion/arena/ArenaVector.h>
 #include <ion/arena/ArenaUtil.h>
+#include <ion/hw/SIMD.h>
+
+#include <type_traits>
 
 namespace ion::graph
 {
@@ -25,6 +28,33 @@ class Resource;
 
 [[nodiscard]] constexpr uint16_t NodeGroupIdx(uint16_t typeId) { return (typeId >> 8); }
 
+// Node type can provide batched update, which is used instead of Update():
+//   static void UpdateBatch(T* nodes, size_t count, GraphContextType& context);
+// Nodes are given as contiguous slices of node block. Slices of full block start at multiples of batch width, thus node type
+// can gather fields of whole lanes to RawBatch. Batch width is T::UpdateBatchWidth if defined, otherwise width of
+// RawBatch. UpdateBatch() can return bool to tell if output of any node of the slice changed.
+template <typename T, typename = void>
+struct HasUpdateBatch : std::false_type
+{
+};
+
+template <typename T>
+struct HasUpdateBatch<
+  T, std::void_t<decltype(T::UpdateBatch(std::declval<T*>(), size_t(0), std::declval<typename T::GraphContextType&>()))>>
+  : std::true_type
+{
+};
+
+template <typename T, typename = void>
+struct NodeBatchWidth : std::integral_constant<size_t, ION_BATCH_SIZE>
+{
+};
+
+template <typename T>
+struct NodeBatchWidth<T, std::void_t<decltype(T::UpdateBatchWidth)>> : std::integral_constant<size_t, T::UpdateBatchWidth>
+{
+};
+
 template <typename GraphResource>
 struct BaseNodeRegistry
 {
@@ -89,7 +119,67 @@ struct BaseNodeRegistry
 		}
 	}
 
+	// Updates nodes of given indices in order. If 'changed' is given, it is set for each node to the result of Update() when
+	// Update() returns bool, otherwise node output is considered changed. Batched node types are updated in runs of
+	// consecutive indices.
+	template <typename T>
+	static void NodeIndexedEntryPoint(ArenaVector<uint8_t>& nodeData, const uint32_t* indices, size_t count, void* userData,
+									  uint8_t* changed)
+	{
+		T* nodes = ion::AssumeAligned<T>(reinterpret_cast<T*>(nodeData.Data()));
+		auto& context = *static_cast<typename T::GraphContextType*>(userData);
+		if constexpr (HasUpdateBatch<T>::value)
+		{
+			size_t runStart = 0;
+			for (size_t i = 1; i <= count; ++i)
+			{
+				if (i < count && indices[i] == indices[i - 1] + 1)
+				{
+					continue;
+				}
+				uint8_t isChanged = 1;
+				if constexpr (std::is_same_v<decltype(T::UpdateBatch(nodes, count, context)), bool>)
+				{
+					isChanged = T::UpdateBatch(&nodes[indices[runStart]], i - runStart, context) ? 1 : 0;
+				}
+				else
+				{
+					T::UpdateBatch(&nodes[indices[runStart]], i - runStart, context);
+				}
+				if (changed)
+				{
+					memset(&changed[runStart], isChanged, i - runStart);
+				}
+				runStart = i;
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if constexpr (std::is_same_v<decltype(nodes[0].Update(context)), bool>)
+				{
+					const bool isChanged = nodes[indices[i]].Update(context);
+					if (changed)
+					{
+						changed[i] = isChanged ? 1 : 0;
+					}
+				}
+				else
+				{
+					nodes[indices[i]].Update(context);
+					if (changed)
+					{
+						changed[i] = 1;
+					}
+				}
+			}
+		}
+	}
+
 	using NodeRunFunc = void (*)(ArenaVector<uint8_t>& nodeData, void* userData, ion::JobScheduler& js);
+	using NodeRunIndexedFunc = void (*)(ArenaVector<uint8_t>& nodeData, const uint32_t* indices, size_t count, void* userData,
+										uint8_t* changed);
 	using NodeDebugFunc = void (*)(ArenaVector<uint8_t>& nodeData, void* userData);
 	using NodeCopyFunc = void (*)(GraphResource& resource, ArenaVector<uint8_t>& nodeData, const ArenaVector<uint8_t>& otherNodeData);
 	using NodeClearFunc = void (*)(GraphResource& resource, ArenaVector<uint8_t>& nodeData);
@@ -102,6 +192,7 @@ struct BaseNodeRegistry
 			auto groupIdx = ion::graph::NodeGroupIdx(T::Type);
 			auto typeIdx = ion::graph::NodeTypeIdx(T::Type);
 			mEntryPoints[groupIdx][typeIdx] = &T::EntryPoint;
+			mIndexedEntryPoints[groupIdx][typeIdx] = &NodeIndexedEntryPoint<T>;
 			mDebugEntryPoints[groupIdx][typeIdx] = &T::DebugEntryPoint;
 			mCopyFunctions[groupIdx][typeIdx] = &NodeCopy<GraphResource, T>;
 			mClearFunctions[groupIdx][typeIdx] = &NodeClear<GraphResource, T>;
@@ -112,6 +203,7 @@ struct BaseNodeRegistry
 	inline void ForEachFunctionType(Callback&& callback)
 	{
 		callback(mEntryPoints);
+		callback(mIndexedEntryPoints);
 		callback(mCopyFunctions);
 		callback(mClearFunctions);
 		callback(mDebugEntryPoints);
@@ -133,6 +225,7 @@ struct BaseNodeRegistry
 	}
 
 	ion::Array<ArenaVector<NodeRunFunc>, NodeGroupCount> mEntryPoints;
+	ion::Array<ArenaVector<NodeRunIndexedFunc>, NodeGroupCount> mIndexedEntryPoints;
 	ion::Array<ArenaVector<NodeCopyFunc>, NodeGroupCount> mCopyFunctions;
 	ion::Array<ArenaVector<NodeClearFunc>, NodeGroupCount> mClearFunctions;
 	ion::Array<ArenaVector<NodeDebugFunc>, NodeGroupCount> mDebugEntryPoints;
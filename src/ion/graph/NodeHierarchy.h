@@ -19,6 +19,7 @@
 #include <ion/container/Array.h>
 #include <ion/container/Algorithm.h>
 #include <ion/container/ForEach.h>
+#include <ion/util/Bits.h>
 #include <ion/jobs/JobScheduler.h>
 #include <ion/graph/BaseNodeRegistry.h>
 #include <ion/memory/TSMultiPoolResource.h>
@@ -26,6 +27,8 @@
 
 #include <ion/container/UnorderedMap.h>
 
+#include <atomic>
+
 // Force multithreading to detect issues early
 #ifndef ION_GRAPH_FORCE_MULTITHREADING
 	#define ION_GRAPH_FORCE_MULTITHREADING ION_BUILD_DEBUG
@@ -68,6 +71,15 @@ namespace ion::graph
 // 2. After ADF of phase-0 are done, start processing nodes BGHE in phase-1
 // 3. After BGH of phase-1 are done, process nodes CI of phase-2.
 //
+// With Scheduling::GraphDependencies graphs are divided to lanes of consecutive graph ids with about equal number of nodes
+// instead. Each lane processes all its phases in order and lanes are processed in parallel, thus phase of a graph waits only
+// for previous phases of graphs in the same lane. Nodes of a lane are still processed in batches of the same type. Nodes must
+// not depend on nodes of other graphs.
+//
+// In incremental mode only dirty nodes are evaluated. Each node block has a dirty bit per node and a count of dirty nodes: new
+// nodes and nodes marked with MarkDirty() are dirty, and when node's Update() returns true, or does not return bool, node of
+// the next phase of the graph becomes dirty. Blocks without dirty nodes are skipped without scanning their nodes.
+//
 template <size_t MaxPhases = 8, typename GraphId = uint32_t>
 class NodeHierarchy
 {
@@ -76,6 +88,24 @@ public:
 	using RegistryResource = TSMultiPoolResourceDefault<16 * 1024, ion::tag::NodeGraph>;
 	using NodeRegistry = BaseNodeRegistry<Resource>;
 
+	enum class Scheduling : uint8_t
+	{
+		PhaseBarriers,	   // Phase starts when all partition-0 nodes of previous phase are done
+		GraphDependencies  // Phase of a graph starts when previous phases of graphs in the same lane are done
+	};
+
+	// Lanes per job scheduler thread in GraphDependencies scheduling. More lanes balance uneven graphs better.
+	static constexpr size_t LanesPerThread = 4;
+
+	// Dirty nodes of block are split to jobs of this size in incremental mode
+	static constexpr size_t IncrementalBatchSize = 256;
+
+	struct EvaluationStats
+	{
+		size_t mNumEvaluated = 0;
+		size_t mNumSkipped = 0;
+	};
+
 private:
 	Resource mResource;
 	const NodeRegistry* mTypeInfo;
@@ -193,6 +223,10 @@ public:
 		{
 			mGraphInfo[i].Copy(mResource, other.mGraphInfo[i]);
 		}
+		mScheduling = other.mScheduling;
+		mIsLaneScheduleValid = false;
+		mNodePhases = other.mNodePhases;
+		mIsIncremental = other.mIsIncremental;
 		return *this;
 	}
 
@@ -213,6 +247,11 @@ public:
 	{
 		T* iter = ion::AssumeAligned<T>(reinterpret_cast<T*>(nodeData.Data()));
 
+		if constexpr (HasUpdateBatch<T>::value)
+		{
+			NodeBatchEntryPoint<T, batchSize>(iter, nodeData.Size() / sizeof(T), userData, js);
+		}
+		else
 #if ION_GRAPH_FORCE_MULTITHREADING
 		if constexpr (true)
 #else
@@ -238,6 +277,30 @@ public:
 		}
 	}
 
+	// Splits nodes to slices of whole batches and calls T::UpdateBatch() for each slice
+	template <typename T, ion::UInt batchSize, typename GraphContextType>
+	static inline void NodeBatchEntryPoint(T* nodes, size_t count, GraphContextType& userData, ion::JobScheduler& js)
+	{
+		constexpr size_t BatchWidth = NodeBatchWidth<T>::value;
+		static_assert(BatchWidth > 0, "Invalid batch width");
+		constexpr size_t SliceSize = (ion::Max(size_t(batchSize), BatchWidth) + BatchWidth - 1) / BatchWidth * BatchWidth;
+		if (count <= SliceSize)
+		{
+			if (count > 0)
+			{
+				T::UpdateBatch(nodes, count, userData);
+			}
+			return;
+		}
+		const size_t numSlices = (count + SliceSize - 1) / SliceSize;
+		js.ParallelForIndex(0, ion::UInt(numSlices), ion::JobScheduler::DefaultPartitionSize(numSlices), 1u,
+							[&](ion::UInt slice)
+							{
+								const size_t first = size_t(slice) * SliceSize;
+								T::UpdateBatch(&nodes[first], ion::Min(SliceSize, count - first), userData);
+							});
+	}
+
 	template <typename T, typename GraphContextType>
 	static inline void NodeDebugEntryPoint(ArenaVector<uint8_t>& nodeData, GraphContextType& userData)
 	{
@@ -254,9 +317,59 @@ public:
 	void Run(void* userData, ion::JobScheduler& js)
 	{
 		ION_PROFILER_SCOPE(NodeScript, "Node Script");
+		mNumEvaluated = 0;
+		mNumSkipped = 0;
+		if (!mIsIncremental)
+		{
+			for (size_t phase = 0; IsPhaseValid(phase); ++phase)
+			{
+				mNumEvaluated += mNumNodesPerPhase[phase];
+			}
+		}
+		if (mScheduling == Scheduling::GraphDependencies)
+		{
+			ProcessLanes(userData, js);
+			return;
+		}
 		ProcessPhase(userData, 0, js);
 	}
 
+	void SetScheduling(Scheduling scheduling) { mScheduling = scheduling; }
+
+	[[nodiscard]] Scheduling GetScheduling() const { return mScheduling; }
+
+	// In incremental mode Run() evaluates only dirty nodes
+	void SetIncremental(bool isEnabled) { mIsIncremental = isEnabled; }
+
+	[[nodiscard]] bool IsIncremental() const { return mIsIncremental; }
+
+	// Marks node of graph in phase to be evaluated on next run. Phase is absolute, i.e. firstPhase given to Reserve() is
+	// included. Call between runs.
+	void MarkDirty(GraphId graphId, UInt phase)
+	{
+		ION_ASSERT(phase < MaxPhases, "Invalid phase");
+		ION_ASSERT(mNodePhases[graphId] & (PhaseMask(1) << phase), "Graph has no node in phase " << phase);
+		MarkNodeDirty(graphId, phase);
+	}
+
+	// Marks all nodes of graph to be evaluated on next run. Call between runs.
+	void MarkDirty(GraphId graphId)
+	{
+		for (PhaseMask phases = mNodePhases[graphId]; phases != 0; phases &= phases - 1)
+		{
+			MarkNodeDirty(graphId, UInt(ion::CountTrailingZeroes(phases)));
+		}
+	}
+
+	// Number of nodes evaluated and skipped by the last run
+	[[nodiscard]] EvaluationStats LastRunStats() const
+	{
+		EvaluationStats stats;
+		stats.mNumEvaluated = mNumEvaluated.load(std::memory_order_relaxed);
+		stats.mNumSkipped = mNumSkipped.load(std::memory_order_relaxed);
+		return stats;
+	}
+
 	struct GraphUpdater
 	{
 		NodeHierarchy& mGraph;
@@ -312,6 +425,7 @@ public:
 		if (mGraphInfo.Size() <= graphId)
 		{
 			Resize(mResource, mGraphInfo, graphId + 1, graphId * 2 + 1);
+			mNodePhases.Resize(mGraphInfo.Size(), graphId * 2 + 1);
 		}
 		ION_ASSERT(mGraphInfo[graphId].nodes.Size() == 0, "Invalid node state");
 		{
@@ -362,7 +476,15 @@ public:
 			ResizeFast(mResource, block.graphIds, index + 1, index * 2 + 1);
 		}
 		block.graphIds[index] = graphId;
-		mGraphInfo[graphId].nodes[phaseId].index = index;
+		if (block.dirtyWords.Size() <= index / 64)
+		{
+			block.dirtyWords.Resize(index / 64 + 1);
+		}
+		SetDirtyBit(block, index);
+		mGraphInfo[graphId].nodes[phaseId] =
+		  NodeIndex{index, ion::SafeRangeCast<uint16_t>(blockIndex), isFinalNode ? uint8_t(1) : uint8_t(0)};
+		mNodePhases[graphId] |= PhaseMask(1) << phaseId;
+		mIsLaneScheduleValid = false;
 		return node;
 	}
 
@@ -378,6 +500,7 @@ public:
 		auto index = mGraphInfo[graphId].nodes[phase].index;
 		ION_ASSERT(block.graphIds[index] == graphId, "Found graph " << block.graphIds[index] << " at index " << index);
 		t[index].~T();
+		ClearDirtyBit(block, index);
 		auto lastIndex = block.data.Size() / sizeof(T) - 1;
 		if (index != lastIndex)
 		{
@@ -385,6 +508,10 @@ public:
 			t[lastIndex].~T();
 			auto otherGraphId = block.graphIds[lastIndex];
 			block.graphIds[index] = otherGraphId;
+			if (ClearDirtyBit(block, lastIndex))
+			{
+				SetDirtyBit(block, index);
+			}
 
 			{
 				if (mGraphInfo[otherGraphId].nodes.Size() != 0)
@@ -406,10 +533,25 @@ public:
 				ArenaAllocator<T, Resource> allocator(&mResource);
 				block.data.ShrinkToFit(allocator);
 			}
+			auto& phaseBlocks = mPhases[partition][phase].nodeBlocks;
 			mPhases[partition][phase].RemoveBlock(mResource, blockIndex, T::Type);
+			if (blockIndex < phaseBlocks.Size())
+			{
+				// Last block was moved to removed block
+				for (size_t i = 0; i < phaseBlocks[blockIndex].graphIds.Size(); ++i)
+				{
+					auto& nodes = mGraphInfo[phaseBlocks[blockIndex].graphIds[i]].nodes;
+					if (nodes.Size() != 0)
+					{
+						nodes[phase].block = ion::SafeRangeCast<uint16_t>(blockIndex);
+					}
+				}
+			}
 		}
+		mNodePhases[graphId] &= ~(PhaseMask(1) << phase);
 		ION_ASSERT(mNumNodesPerPhase[phase] > 0, "Invalid node count");
 		mNumNodesPerPhase[phase]--;
+		mIsLaneScheduleValid = false;
 	}
 
 	void SetDebugging(bool isEnabled) { mIsDebugging = isEnabled; }
@@ -423,7 +565,16 @@ private:
 		js.ParallelFor(mPhases[partition][phase].nodeBlocks.Begin(), mPhases[partition][phase].nodeBlocks.End(),
 					   partitionWorkLoad > 1.0f ? 0u : numNodeBlocks, 1u,
 					   [&](auto& block)
-					   { mTypeInfo->mEntryPoints[NodeGroupIdx(block.typeId)][NodeTypeIdx(block.typeId)](block.data, userData, js); });
+					   {
+						   if (mIsIncremental)
+						   {
+							   EvaluateDirtyBlock(block, phase, userData, js);
+						   }
+						   else
+						   {
+							   mTypeInfo->mEntryPoints[NodeGroupIdx(block.typeId)][NodeTypeIdx(block.typeId)](block.data, userData, js);
+						   }
+					   });
 		if ION_UNLIKELY (mIsDebugging)
 		{
 			ion::ForEach(mPhases[partition][phase].nodeBlocks, [&](auto& block)
@@ -433,6 +584,302 @@ private:
 
 	inline bool IsPhaseValid(size_t phase) const { return phase < MaxPhases && mNumNodesPerPhase[phase] != 0; }
 
+	struct LaneBatch
+	{
+		uint32_t mFirst;  // First node in mLaneNodeIndices
+		uint32_t mCount;
+		uint16_t mBlock;
+		uint8_t mPhase;
+		uint8_t mPartition;
+	};
+
+	struct Lane
+	{
+		uint32_t mFirstBatch = 0;
+		uint32_t mLastBatch = 0;
+		// Scratch buffers of incremental mode, reused between runs
+		ion::Vector<uint32_t> mDirtyIndices;
+		ion::Vector<uint8_t> mChanged;
+	};
+
+	template <typename NodeBlock>
+	static bool IsDirty(NodeBlock& block, size_t index)
+	{
+		const uint64_t word = std::atomic_ref<uint64_t>(block.dirtyWords[index / 64]).load(std::memory_order_relaxed);
+		return word & (uint64_t(1) << (index % 64));
+	}
+
+	// Sets dirty bit of node and returns true if node was clean. Safe to call concurrently.
+	template <typename NodeBlock>
+	static bool SetDirtyBit(NodeBlock& block, size_t index)
+	{
+		const uint64_t bit = uint64_t(1) << (index % 64);
+		if (std::atomic_ref<uint64_t>(block.dirtyWords[index / 64]).fetch_or(bit, std::memory_order_relaxed) & bit)
+		{
+			return false;
+		}
+		std::atomic_ref<uint32_t>(block.numDirty).fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Clears dirty bit of node and returns true if node was dirty. Safe to call concurrently.
+	template <typename NodeBlock>
+	static bool ClearDirtyBit(NodeBlock& block, size_t index)
+	{
+		const uint64_t bit = uint64_t(1) << (index % 64);
+		if ((std::atomic_ref<uint64_t>(block.dirtyWords[index / 64]).fetch_and(~bit, std::memory_order_relaxed) & bit) == 0)
+		{
+			return false;
+		}
+		std::atomic_ref<uint32_t>(block.numDirty).fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void MarkNodeDirty(GraphId graphId, UInt phase)
+	{
+		const NodeIndex& node = mGraphInfo[graphId].nodes[phase];
+		SetDirtyBit(mPhases[node.partition][phase].nodeBlocks[node.block], node.index);
+	}
+
+	// Next phase after given phase that has node of graph, or MaxPhases if none
+	UInt NextPhase(GraphId graphId, UInt phase) const
+	{
+		const PhaseMask nextPhases = mNodePhases[graphId] & ~((PhaseMask(2) << phase) - 1);
+		return nextPhases != 0 ? UInt(ion::CountTrailingZeroes(nextPhases)) : UInt(MaxPhases);
+	}
+
+	// Evaluates dirty nodes of block, block without dirty nodes is skipped without scanning its nodes. Used with phase
+	// barriers, thus dirty bits of block are not modified concurrently.
+	template <typename NodeBlock>
+	void EvaluateDirtyBlock(NodeBlock& block, uint8_t phase, void* userData, ion::JobScheduler& js)
+	{
+		const size_t numDirty = block.numDirty;
+		mNumSkipped.fetch_add(block.graphIds.Size() - numDirty, std::memory_order_relaxed);
+		if (numDirty == 0)
+		{
+			return;
+		}
+		block.dirtyIndices.Clear();
+		for (size_t i = 0; i < block.dirtyWords.Size(); ++i)
+		{
+			for (uint64_t word = block.dirtyWords[i]; word != 0; word &= word - 1)
+			{
+				block.dirtyIndices.Add(uint32_t(i * 64 + size_t(ion::CountTrailingZeroes(word))));
+			}
+		}
+		EvaluateNodes(block, phase, block.dirtyIndices, block.changed, userData, &js);
+	}
+
+	// Evaluates dirty nodes among given nodes of block. Nodes of other lanes can be evaluated concurrently.
+	template <typename NodeBlock>
+	void EvaluateDirtyBatch(NodeBlock& block, uint8_t phase, const uint32_t* indices, uint32_t count, Lane& lane, void* userData)
+	{
+		if (std::atomic_ref<uint32_t>(block.numDirty).load(std::memory_order_relaxed) == 0)
+		{
+			mNumSkipped.fetch_add(count, std::memory_order_relaxed);
+			return;
+		}
+		lane.mDirtyIndices.Clear();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (IsDirty(block, indices[i]))
+			{
+				lane.mDirtyIndices.Add(indices[i]);
+			}
+		}
+		mNumSkipped.fetch_add(count - lane.mDirtyIndices.Size(), std::memory_order_relaxed);
+		if (!lane.mDirtyIndices.IsEmpty())
+		{
+			EvaluateNodes(block, phase, lane.mDirtyIndices, lane.mChanged, userData, nullptr);
+		}
+	}
+
+	// Evaluates given nodes of block using caller's scratch buffer for change flags. Nodes are split to jobs if job scheduler
+	// is given. Dirty bits of evaluated nodes are cleared and node of the next phase of graph is marked dirty if node output
+	// changed.
+	template <typename NodeBlock>
+	void EvaluateNodes(NodeBlock& block, uint8_t phase, const ion::Vector<uint32_t>& nodes, ion::Vector<uint8_t>& changed,
+					   void* userData, ion::JobScheduler* js)
+	{
+		mNumEvaluated.fetch_add(nodes.Size(), std::memory_order_relaxed);
+		changed.Resize(nodes.Size());
+		auto entryPoint = mTypeInfo->mIndexedEntryPoints[NodeGroupIdx(block.typeId)][NodeTypeIdx(block.typeId)];
+		const size_t numBatches = (nodes.Size() + IncrementalBatchSize - 1) / IncrementalBatchSize;
+		auto evaluateBatch = [&](size_t batch)
+		{
+			const size_t offset = batch * IncrementalBatchSize;
+			entryPoint(block.data, &nodes[offset], ion::Min(IncrementalBatchSize, size_t(nodes.Size()) - offset), userData,
+					   &changed[offset]);
+		};
+		if (js && numBatches > 1)
+		{
+			js->ParallelForIndex(0, numBatches, 1u, 1u, [&](UInt batch) { evaluateBatch(batch); });
+		}
+		else
+		{
+			for (size_t batch = 0; batch < numBatches; ++batch)
+			{
+				evaluateBatch(batch);
+			}
+		}
+
+		for (size_t i = 0; i < nodes.Size(); ++i)
+		{
+			ClearDirtyBit(block, nodes[i]);
+			if (changed[i])
+			{
+				const GraphId graphId = block.graphIds[nodes[i]];
+				const UInt nextPhase = NextPhase(graphId, phase);
+				if (nextPhase < MaxPhases)
+				{
+					MarkNodeDirty(graphId, nextPhase);
+				}
+			}
+		}
+	}
+
+	void ProcessLanes(void* userData, ion::JobScheduler& js)
+	{
+		BuildLaneSchedule(js);
+		js.ParallelFor(mLanes.Begin(), mLanes.End(), 1u, 1u, [&](Lane& lane) { ProcessLane(userData, lane); });
+		if ION_UNLIKELY (mIsDebugging)
+		{
+			for (uint8_t phase = 0; IsPhaseValid(phase); ++phase)
+			{
+				for (uint8_t partition = 0; partition < 2; ++partition)
+				{
+					ion::ForEach(mPhases[partition][phase].nodeBlocks, [&](auto& block)
+								 { mTypeInfo->mDebugEntryPoints[NodeGroupIdx(block.typeId)][NodeTypeIdx(block.typeId)](block.data, userData); });
+				}
+			}
+		}
+	}
+
+	void ProcessLane(void* userData, Lane& lane)
+	{
+		ION_PROFILER_SCOPE_DETAIL(NodeScript, "Node Lane", lane.mLastBatch - lane.mFirstBatch);
+		for (uint32_t i = lane.mFirstBatch; i < lane.mLastBatch; ++i)
+		{
+			const LaneBatch& batch = mLaneBatches[i];
+			auto& block = mPhases[batch.mPartition][batch.mPhase].nodeBlocks[batch.mBlock];
+			if (mIsIncremental)
+			{
+				EvaluateDirtyBatch(block, batch.mPhase, &mLaneNodeIndices[batch.mFirst], batch.mCount, lane, userData);
+			}
+			else
+			{
+				mTypeInfo->mIndexedEntryPoints[NodeGroupIdx(block.typeId)][NodeTypeIdx(block.typeId)](
+				  block.data, &mLaneNodeIndices[batch.mFirst], batch.mCount, userData, nullptr);
+			}
+		}
+	}
+
+	// Calls callback(partition, phase, blockIndex, block) for node blocks in processing order
+	template <typename Callback>
+	void ForEachBlockInOrder(Callback&& callback)
+	{
+		for (uint8_t phase = 0; IsPhaseValid(phase); ++phase)
+		{
+			for (uint8_t partition = 0; partition < 2; ++partition)
+			{
+				auto& blocks = mPhases[partition][phase].nodeBlocks;
+				for (uint16_t blockIndex = 0; blockIndex < blocks.Size(); ++blockIndex)
+				{
+					callback(partition, phase, blockIndex, blocks[blockIndex]);
+				}
+			}
+		}
+	}
+
+	// Sorts node indices by lane. Within a lane nodes are in processing order and consecutive nodes of the same block form a
+	// batch.
+	void BuildLaneSchedule(ion::JobScheduler& js)
+	{
+		const size_t numGraphs = mGraphInfo.Size();
+		const size_t numLanes = ion::Min(numGraphs, (size_t(js.GetPool().GetWorkerCount()) + 1) * LanesPerThread);
+		if (mIsLaneScheduleValid && numLanes == mLanes.Size())
+		{
+			return;
+		}
+		ION_PROFILER_SCOPE(NodeScript, "Node Lane Schedule");
+		mIsLaneScheduleValid = true;
+		mLanes.Clear();
+		mLanes.Resize(numLanes);
+
+		// Lanes are ranges of consecutive graphs with about equal number of nodes, thus deep graphs do not end up in the same lane
+		// when graphs of similar depth are created together
+		ion::Vector<uint32_t> graphLanes;
+		graphLanes.ResizeFast(numGraphs);
+		{
+			size_t numNodes = 0;
+			for (size_t graphId = 0; graphId < numGraphs; ++graphId)
+			{
+				numNodes += size_t(ion::PopCount(mNodePhases[graphId]));
+			}
+			size_t nodesBefore = 0;
+			for (size_t graphId = 0; graphId < numGraphs; ++graphId)
+			{
+				graphLanes[graphId] = numNodes != 0 ? uint32_t(ion::Min(nodesBefore * numLanes / numNodes, numLanes - 1)) : 0;
+				nodesBefore += size_t(ion::PopCount(mNodePhases[graphId]));
+			}
+		}
+		auto laneOf = [&](GraphId graphId) { return size_t(graphLanes[graphId]); };
+
+		// Count nodes and batches of each lane
+		ion::Vector<uint32_t> lastBlock;
+		ion::Vector<uint32_t> nodeOffsets;
+		lastBlock.Resize(numLanes);
+		nodeOffsets.Resize(numLanes + 1);
+		uint32_t blockSerial = 0;
+		ForEachBlockInOrder(
+		  [&](uint8_t, uint8_t, uint16_t, auto& block)
+		  {
+			  blockSerial++;
+			  for (size_t i = 0; i < block.graphIds.Size(); ++i)
+			  {
+				  const size_t lane = laneOf(block.graphIds[i]);
+				  if (lastBlock[lane] != blockSerial)
+				  {
+					  lastBlock[lane] = blockSerial;
+					  mLanes[lane].mLastBatch++;
+				  }
+				  nodeOffsets[lane + 1]++;
+			  }
+		  });
+		uint32_t numBatches = 0;
+		for (size_t lane = 0; lane < numLanes; ++lane)
+		{
+			mLanes[lane].mFirstBatch = numBatches;
+			numBatches += mLanes[lane].mLastBatch;
+			mLanes[lane].mLastBatch = mLanes[lane].mFirstBatch;
+			nodeOffsets[lane + 1] += nodeOffsets[lane];
+			lastBlock[lane] = 0;
+		}
+
+		// Fill batches, mLastBatch is used as write position
+		mLaneBatches.Clear();
+		mLaneBatches.Resize(numBatches);
+		mLaneNodeIndices.Clear();
+		mLaneNodeIndices.Resize(nodeOffsets[numLanes]);
+		blockSerial = 0;
+		ForEachBlockInOrder(
+		  [&](uint8_t partition, uint8_t phase, uint16_t blockIndex, auto& block)
+		  {
+			  blockSerial++;
+			  for (size_t i = 0; i < block.graphIds.Size(); ++i)
+			  {
+				  const size_t lane = laneOf(block.graphIds[i]);
+				  if (lastBlock[lane] != blockSerial)
+				  {
+					  lastBlock[lane] = blockSerial;
+					  mLaneBatches[mLanes[lane].mLastBatch++] = LaneBatch{nodeOffsets[lane], 0, blockIndex, phase, partition};
+				  }
+				  mLaneBatches[mLanes[lane].mLastBatch - 1].mCount++;
+				  mLaneNodeIndices[nodeOffsets[lane]++] = uint32_t(i);
+			  }
+		  });
+	}
+
 	void ProcessPhase(void* userData, const uint8_t phase, ion::JobScheduler& js)
 	{
 		ION_PROFILER_SCOPE(NodeScript, "Node Phase");
@@ -471,7 +918,14 @@ private:
 			NodeBlock() {}
 			NodeBlock(NodeType type) : typeId(type) {}
 			NodeBlock(const NodeBlock& other) = delete;
-			NodeBlock(NodeBlock&& other) : graphIds(std::move(other.graphIds)), data(std::move(other.data)), typeId(other.typeId) {}
+			NodeBlock(NodeBlock&& other)
+			  : graphIds(std::move(other.graphIds)),
+				data(std::move(other.data)),
+				dirtyWords(std::move(other.dirtyWords)),
+				numDirty(other.numDirty),
+				typeId(other.typeId)
+			{
+			}
 
 			NodeBlock& operator=(const NodeBlock& other) = delete;
 			NodeBlock& operator=(NodeBlock&& other) = delete;
@@ -488,11 +942,19 @@ private:
 					ArenaAllocator<uint8_t, Resource> allocator(&resource);
 					data.Set(allocator, std::move(other.data));
 				}
+				dirtyWords = std::move(other.dirtyWords);
+				numDirty = other.numDirty;
 				return *this;
 			}
 
 			ArenaVector<GraphId> graphIds;
 			ArenaVector<uint8_t> data;
+			// Dirty bit of each node and number of dirty nodes for incremental mode
+			ion::Vector<uint64_t> dirtyWords;
+			uint32_t numDirty = 0;
+			// Scratch buffers of incremental mode, reused between runs
+			ion::Vector<uint32_t> dirtyIndices;
+			ion::Vector<uint8_t> changed;
 			NodeType typeId;
 
 			template <typename Resource>
@@ -548,6 +1010,8 @@ private:
 					   other.nodeBlocks[i].graphIds.Size() * sizeof(GraphId));
 
 				typeInfo.mCopyFunctions[NodeGroupIdx(type)][NodeTypeIdx(type)](resource, nodeBlocks[i].data, other.nodeBlocks[i].data);
+				nodeBlocks[i].dirtyWords = other.nodeBlocks[i].dirtyWords;
+				nodeBlocks[i].numDirty = other.nodeBlocks[i].numDirty;
 			}
 			mTypeToBlockMap = other.mTypeToBlockMap;
 		}
@@ -589,7 +1053,9 @@ private:
 
 	struct NodeIndex
 	{
-		uint32_t index;
+		uint32_t index;	 // Node in block
+		uint16_t block;	 // Block in phase
+		uint8_t partition;
 	};
 
 	// Indices of graph's nodes
@@ -605,6 +1071,22 @@ private:
 	Array<Array<Phase, MaxPhases>, 2> mPhases;
 	Array<uint32_t, MaxPhases> mNumNodesPerPhase;
 	ArenaVector<GraphInfo> mGraphInfo;
+
+	// Phases that have node of graph, used to find next node of graph in incremental mode
+	using PhaseMask = uint64_t;
+	static_assert(MaxPhases < sizeof(PhaseMask) * 8, "Too many phases for phase mask");
+	ion::Vector<PhaseMask> mNodePhases;
+	std::atomic<size_t> mNumEvaluated = 0;
+	std::atomic<size_t> mNumSkipped = 0;
+	bool mIsIncremental = false;
+
+	// Schedule of GraphDependencies, rebuilt when nodes are added or removed
+	ion::Vector<Lane> mLanes;
+	ion::Vector<LaneBatch> mLaneBatches;
+	ion::Vector<uint32_t> mLaneNodeIndices;	 // Node indices in blocks
+	bool mIsLaneScheduleValid = false;
+
+	Scheduling mScheduling = Scheduling::PhaseBarriers;
 	bool mIsDebugging = false;
 };
 }  // namespace ion::graph
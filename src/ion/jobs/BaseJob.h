@@ -30,7 +30,7 @@ public:
 	BaseJob(BaseJob* sourceJob = nullptr)
 	  : mSourceJob(sourceJob),
 		mJobRecursion(mSourceJob ? mSourceJob->GetRecursion() + 1 : 0)
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 		,
 		mTag(mSourceJob ? mSourceJob->Tag() : ion::tag::Unset)
 #endif
@@ -38,20 +38,20 @@ public:
 	}
 
 	BaseJob(MemTag
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 			  tag
 #endif
 			)
 	  : mSourceJob(nullptr),
 		mJobRecursion(0)
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 		,
 		mTag(tag)
 #endif
 	{
 	}
 
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 	MemTag Tag() const { return mTag; }
 
 	void SetTag(MemTag tag) { mTag = tag; }
@@ -120,7 +120,7 @@ public:
 
 private:
 	const UInt mJobRecursion;
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 	MemTag mTag;
 #endif
 	Type mType = Type::CoreJob;
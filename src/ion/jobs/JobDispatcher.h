@@ -16,7 +16,7 @@
 #pragma once
 #include <ion/container/Vector.h>
 
-#include <ion/memory/TSObjectPool.h>
+#include <ion/memory/TSMagazinePool.h>
 
 #include <ion/concurrency/MPSCQueue.h>
 #include <ion/concurrency/Runner.h>
@@ -45,7 +45,7 @@ public:
 
 	inline ion::ThreadPool& ThreadPool() { return mThreadPool; }
 
-	ion::ThreadSafeObjectPool<DispatcherJob, ion::CoreAllocator<DispatcherJob>>& DispatcherJobPool() { return mDispatcherJobPool; }
+	ion::ThreadSafeMagazinePool<DispatcherJob, ion::CoreAllocator<DispatcherJob>>& DispatcherJobPool() { return mDispatcherJobPool; }
 
 	void WakeUp();
 
@@ -73,7 +73,7 @@ private:
 	SCThreadSynchronizer mSynchronizer;
 	Vector<DispatcherJob*, ion::CoreAllocator<DispatcherJob*>> mTimedQueue;	 // #TODO: Use priority queue
 	Runner mThread;
-	ion::ThreadSafeObjectPool<DispatcherJob, ion::CoreAllocator<DispatcherJob>> mDispatcherJobPool;
+	ion::ThreadSafeMagazinePool<DispatcherJob, ion::CoreAllocator<DispatcherJob>> mDispatcherJobPool;
 	std::atomic<TimeUS> mNextUpdate;
 };
 }  // namespace ion
@@ -3,6 +3,8 @@
 #include <ion/jobs/BaseJob.h>
 #include <ion/jobs/JobQueue.h>
 
+#include <ion/memory/FrameArenaResource.h>
+
 #include <ion/hw/CPU.inl>
 
 namespace ion
@@ -14,7 +16,12 @@ inline void DoWork(JobWork& work)
 	ion::platform::PreFetchL2(work.mJob);
 	auto oldJob = ion::Thread::GetCurrentJob();
 	ion::Thread::SetCurrentJob(work.mJob);
-	work.mJob->DoWork();  // After this call mJob is not valid anymore
+	{
+#if ION_CONFIG_SCRATCH_ARENA
+		ion::JobScratchScope scratchScope;
+#endif
+		work.mJob->DoWork();  // After this call mJob is not valid anymore
+	}
 	ion::Thread::SetCurrentJob(oldJob);
 }
 
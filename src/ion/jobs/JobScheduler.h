@@ -24,6 +24,12 @@
 
 namespace ion
 {
+template <typename TAllocator, typename... Ts>
+class BasicSoAVector;
+
+template <typename T, typename TAllocator, size_t FirstSegmentShift>
+class SegmentedVector;
+
 #if 0
 			// Item size is usually not enough information for setting batch size, but it's useful for some cases.
 template <typename Function>
@@ -478,5 +484,72 @@ inline void ParallelForIndex(const size_t start, const size_t end, const ion::UI
 	}
 }
 
+// Calls function(first, last) for ranges of 'chunkSize' indices. Last range can be shorter.
+template <class Function>
+inline void ParallelForChunks(const size_t count, const size_t chunkSize, Function&& function) noexcept
+{
+	ION_ASSERT(chunkSize > 0, "Invalid chunk size");
+	const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+	const ion::UInt partitionSize = ion::JobScheduler::DefaultPartitionSize(numChunks);
+	ParallelForIndex(0, numChunks, partitionSize, 1,
+					 [&](ion::UInt chunk)
+					 {
+						 const size_t first = size_t(chunk) * chunkSize;
+						 function(first, ion::Min(first + chunkSize, count));
+					 });
+}
+
+// Calls function(first, last) for row ranges of SoA vector. Ranges start at multiples of SIMD batch size, thus all but the
+// last range consist of full batches and field data can be loaded to RawBatch directly.
+template <typename TAllocator, typename... Ts, class Function>
+inline void ParallelFor(BasicSoAVector<TAllocator, Ts...>& rows, Function&& function) noexcept
+{
+	constexpr size_t BatchSize = BasicSoAVector<TAllocator, Ts...>::BatchSize;
+	constexpr size_t MinChunkSize = ion::Max(BatchSize, size_t(ION_CONFIG_CACHE_LINE_SIZE));
+	const size_t count = rows.Size();
+	size_t chunkSize = ion::Max(MinChunkSize, count / (ion::MaxQueues * 8));
+	chunkSize = (chunkSize + BatchSize - 1) / BatchSize * BatchSize;
+	ParallelForChunks(count, chunkSize, std::forward<Function>(function));
+}
+
+// Calls function(T* data, size_t count, size_t firstIndex) for contiguous ranges of segmented vector. Large segments are
+// split to multiple ranges, ranges never cross segment boundaries.
+template <typename T, typename TAllocator, size_t FirstSegmentShift, class Function>
+inline void ParallelFor(SegmentedVector<T, TAllocator, FirstSegmentShift>& items, Function&& function) noexcept
+{
+	using Items = SegmentedVector<T, TAllocator, FirstSegmentShift>;
+	const size_t count = items.Size();
+	size_t chunkSize = Items::FirstSegmentSize;
+	while (chunkSize < count / (ion::MaxQueues * 8))
+	{
+		chunkSize *= 2;
+	}
+
+	// Tasks per segment, there are at most 64 segments
+	size_t lastTask[Items::MaxSegments];
+	size_t numSegments = 0;
+	size_t numTasks = 0;
+	for (; numSegments < items.NumSegments() && Items::SegmentStart(numSegments) < count; ++numSegments)
+	{
+		numTasks += (items.SegmentCount(numSegments) + chunkSize - 1) / chunkSize;
+		lastTask[numSegments] = numTasks;
+	}
+
+	ParallelForIndex(0, numTasks, ion::JobScheduler::DefaultPartitionSize(numTasks), 1,
+					 [&](ion::UInt task)
+					 {
+						 size_t segment = 0;
+						 while (lastTask[segment] <= task)
+						 {
+							 segment++;
+						 }
+						 const size_t firstTask = segment > 0 ? lastTask[segment - 1] : 0;
+						 const size_t offset = (task - firstTask) * chunkSize;
+						 const size_t segmentCount = items.SegmentCount(segment);
+						 function(items.SegmentData(segment) + offset, ion::Min(chunkSize, segmentCount - offset),
+								  Items::SegmentStart(segment) + offset);
+					 });
+}
+
 
 }  // namespace ion
@@ -3,7 +3,7 @@
 #include <ion/memory/Memory.h>
 #include <ion/memory/MemoryScope.h>
 
-#if ION_CONFIG_DEV_TOOLS
+#if ION_CONFIG_DEV_TOOLS || ION_HEAP_PROFILER
 
 #include <memory>
 
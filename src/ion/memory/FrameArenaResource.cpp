@@ -0,0 +1,59 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ion/memory/FrameArenaResource.h>
+
+namespace ion
+{
+FrameArenaResource::FrameArenaResource(size_t blockSize, size_t largeAllocationSize, size_t virtualMemoryReserve)
+  : mStartBlock(mBuffer.AllocateBlock(blockSize)),
+	mBlockSize(blockSize),
+	mLargeAllocationSize(largeAllocationSize),
+	mVirtualMemoryReserve(virtualMemoryReserve)
+{
+	ION_ASSERT(mStartBlock, "Out of memory");
+	mBuffer.Rewind(mStartBlock);
+}
+
+FrameArenaResource::~FrameArenaResource()
+{
+	mBuffer.RewindAndDeallocate(mStartBlock);
+	mBuffer.DeallocateBlock(mStartBlock);
+}
+
+void FrameArenaResource::Reset()
+{
+	ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
+	mBuffer.Rewind(LinearMemoryBuffer<ion::GlobalAllocator<ion::u8>>::Position{mStartBlock, 0});
+	if (mLargeAllocations)
+	{
+		mLargeAllocations->Rewind(0);
+	}
+}
+
+void* FrameArenaResource::AllocateLarge(size_t len, size_t align)
+{
+	if (!mLargeAllocations)
+	{
+		if (mVirtualMemoryReserve == 0)
+		{
+			return nullptr;
+		}
+		mLargeAllocations = ion::MakeUnique<VirtualMemoryBuffer>(mVirtualMemoryReserve);
+	}
+	return mLargeAllocations->TryAllocate(len, align);
+}
+
+}  // namespace ion
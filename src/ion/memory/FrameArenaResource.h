@@ -0,0 +1,169 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <ion/concurrency/Thread.h>
+
+#include <ion/debug/AccessGuard.h>
+
+#include <ion/memory/GlobalAllocator.h>
+#include <ion/memory/MemoryScope.h>
+#include <ion/memory/MonotonicBufferResource.h>
+#include <ion/memory/UniquePtr.h>
+#include <ion/memory/VirtualMemoryBuffer.h>
+
+namespace ion
+{
+// Linear arena with rewind markers for short-lived allocations, e.g. per frame or per request temporaries.
+//
+// Push() returns marker to current position and Pop() releases everything allocated after the marker in O(1) without touching
+// general purpose allocators. Markers can be nested, but they must be popped in reverse order. Blocks are kept for reuse after
+// rewinding. Allocations of at least 'largeAllocationSize' bytes are placed to virtual memory to avoid keeping big blocks in the
+// block chain, virtual memory is reserved on first large allocation.
+class FrameArenaResource
+{
+public:
+	static constexpr size_t DefaultBlockSize = 64 * 1024;
+	static constexpr size_t DefaultLargeAllocationSize = 256 * 1024;
+#if defined(ION_ARCH_X86_64) || defined(ION_ARCH_ARM_64)
+	static constexpr size_t DefaultVirtualMemoryReserve = size_t(1024) * 1024 * 1024;
+#else
+	static constexpr size_t DefaultVirtualMemoryReserve = size_t(64) * 1024 * 1024;
+#endif
+
+	struct Marker
+	{
+		LinearMemoryBuffer<ion::GlobalAllocator<ion::u8>>::Position mPosition;
+		size_t mLargePosition;
+	};
+
+	ION_CLASS_NON_COPYABLE_NOR_MOVABLE(FrameArenaResource);
+
+	FrameArenaResource(size_t blockSize = DefaultBlockSize, size_t largeAllocationSize = DefaultLargeAllocationSize,
+					   size_t virtualMemoryReserve = DefaultVirtualMemoryReserve);
+
+	~FrameArenaResource();
+
+	[[nodiscard]] Marker Push() const
+	{
+		return Marker{mBuffer.CurrentPosition(), mLargeAllocations ? mLargeAllocations->Position() : 0};
+	}
+
+	void Pop(const Marker& marker)
+	{
+		ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
+		mBuffer.Rewind(marker.mPosition);
+		if (mLargeAllocations)
+		{
+			mLargeAllocations->Rewind(marker.mLargePosition);
+		}
+	}
+
+	// Releases all allocations
+	void Reset();
+
+	ION_RESTRICT_RETURN_VALUE void* Allocate(size_t len, size_t align)
+	{
+		ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
+		if ION_UNLIKELY (len >= mLargeAllocationSize)
+		{
+			void* ptr = AllocateLarge(len, align);
+			if (ptr)
+			{
+				return ptr;
+			}
+		}
+		return mBuffer.Allocate(len, align, mBlockSize);
+	}
+
+	// Memory is released only by Pop() or Reset()
+	void Deallocate(void*, size_t) {}
+
+private:
+	void* AllocateLarge(size_t len, size_t align);
+
+	LinearMemoryBuffer<ion::GlobalAllocator<ion::u8>> mBuffer;
+	detail::MemoryBufferBlock* mStartBlock;
+	ion::UniquePtr<VirtualMemoryBuffer> mLargeAllocations;
+	size_t mBlockSize;
+	size_t mLargeAllocationSize;
+	size_t mVirtualMemoryReserve;
+	ION_ACCESS_GUARD(mGuard);
+};
+
+// Pushes arena marker and sets memory tag for the scope. Arena is rewound when scope ends.
+class FrameArenaScope
+{
+public:
+	ION_CLASS_NON_COPYABLE_NOR_MOVABLE(FrameArenaScope);
+
+	FrameArenaScope(FrameArenaResource& arena, [[maybe_unused]] MemTag tag = ion::tag::Temporary)
+	  : mArena(arena),
+		mMarker(arena.Push())
+#if ION_MEMORY_TAGS
+		,
+		mMemoryScope(tag)
+#endif
+	{
+	}
+
+	~FrameArenaScope() { mArena.Pop(mMarker); }
+
+	FrameArenaResource& Arena() { return mArena; }
+
+private:
+	FrameArenaResource& mArena;
+	const FrameArenaResource::Marker mMarker;
+#if ION_MEMORY_TAGS
+	ion::MemoryScope mMemoryScope;
+#endif
+};
+
+#if ION_CONFIG_SCRATCH_ARENA
+// Rewinds thread's scratch arena when job is done. Scratch arena is created on first use, thus jobs not using scratch memory
+// only pay for checking the thread local arena pointer.
+class JobScratchScope
+{
+public:
+	ION_CLASS_NON_COPYABLE_NOR_MOVABLE(JobScratchScope);
+
+	JobScratchScope() : mArena(ion::Thread::mScratchArena)
+	{
+		if (mArena)
+		{
+			mMarker = mArena->Push();
+		}
+	}
+
+	~JobScratchScope()
+	{
+		if (mArena)
+		{
+			mArena->Pop(mMarker);
+		}
+		else if (ion::Thread::mScratchArena)
+		{
+			// Arena was created by this job
+			ion::Thread::mScratchArena->Reset();
+		}
+	}
+
+private:
+	FrameArenaResource* const mArena;
+	FrameArenaResource::Marker mMarker;
+};
+#endif
+
+}  // namespace ion
@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <ion/Types.h>
 #include <ion/memory/Memory.h>
 
 #include <new>	// std::align_val_t
@@ -143,6 +144,11 @@ constexpr bool operator!=(const ion::GlobalAllocator<T1>&, const ion::GlobalAllo
 	return false;
 }
 
+template <typename T>
+struct IsTriviallyRelocatable<GlobalAllocator<T>> : std::true_type
+{
+};
+
 
 }  // namespace ion
 
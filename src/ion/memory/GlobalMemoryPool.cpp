@@ -20,7 +20,9 @@
 	#include <ion/container/ForEach.h>
 
 	#include <ion/memory/GlobalMemoryPool.h>
+	#include <ion/memory/MemoryAccounting.h>
 	#include <ion/memory/NativeAllocator.h>
+	#include <ion/memory/NumaAllocator.h>
 	#include <ion/memory/TLSFResource.h>
 
 	#include <ion/concurrency/MPSCQueue.h>
@@ -28,6 +30,9 @@
 
 	#include <ion/core/Engine.h>
 
+	#include <ion/util/Bits.h>
+	#include <ion/util/Math.h>
+
 namespace ion
 {
 
@@ -39,10 +44,19 @@ constexpr size_t NumElemsPerBucket = 512;
 
 constexpr size_t MaxGlobalMemoryBlockSize = 128 * 1024;
 
+	#if ION_CONFIG_NUMA
+// Thread-local resources and their blocks are placed to memory node of the thread initializing the resource
+template <typename T>
+using ResourceAllocator = ion::NumaAllocator<T>;
+	#else
+template <typename T>
+using ResourceAllocator = ion::NativeAllocator<T>;
+	#endif
+
 struct Resource
 {
 	#if ION_CONFIG_MEMORY_RESOURCES == 1
-	TLSFResource<MonotonicBufferResource<64 * 1024, ion::tag::External, ion::NativeAllocator<uint8_t>>, ion::tag::External> mTLSF;
+	TLSFResource<MonotonicBufferResource<64 * 1024, ion::tag::External, ResourceAllocator<uint8_t>>, ion::tag::External> mTLSF;
 	#endif
 	MPSCQueue<void*, ion::NativeAllocator<void*>> mFreeElems;
 
@@ -83,19 +97,19 @@ struct Resource
 	}
 };
 
-template <typename T, class... Args>
+template <typename T, typename Allocator = NativeAllocator<T>, class... Args>
 [[nodiscard]] constexpr T* Construct(Args&&... args)
 {
 	memory_tracker::TrackStatic(sizeof(T), ion::tag::External);
-	return new (static_cast<void*>(NativeAllocator<T>().allocate(1))) T(std::forward<Args>(args)...);
+	return new (static_cast<void*>(Allocator().allocate(1))) T(std::forward<Args>(args)...);
 }
 
-template <typename T>
+template <typename T, typename Allocator = NativeAllocator<T>>
 constexpr void Destroy(T* p)
 {
 	memory_tracker::UntrackStatic(sizeof(T), ion::tag::External);
 	p->~T();
-	NativeAllocator<T>().deallocate(p, 1);
+	Allocator().deallocate(p, 1);
 }
 
 struct Bucket
@@ -111,7 +125,7 @@ struct Bucket
 					 {
 						 if (resource)
 						 {
-							 Destroy(resource);
+							 Destroy<Resource, ResourceAllocator<Resource>>(resource);
 						 }
 					 });
 	}
@@ -143,12 +157,29 @@ struct BlockHeader
 {
 	uint32_t mSize;
 	uint16_t mThreadId;
-	uint8_t mAlignment;
-	uint8_t mOffset;  // #TODO: Offset is avail from alignment
+	uint8_t mAlignmentShift : 4;  // Alignment is 8 << shift
+	uint8_t mTag : 4;			  // Memory tag for accounting
+	uint8_t mOffset;			  // #TODO: Offset is avail from alignment
+
+	size_t Alignment() const { return size_t(8) << mAlignmentShift; }
+
+	MemTag Tag() const { return mTag; }
 };
+static_assert(sizeof(BlockHeader) == 8);
+static_assert(tag::Count <= 16, "Memory tag does not fit to block header");
 
-void* InitBlock(void* ptr, size_t size, size_t alignment, uint16_t blockThreadIndex)
+MemTag CurrentTag()
 {
+	#if ION_MEMORY_ACCOUNTING
+	return ion::detail::GetMemoryTag();
+	#else
+	return 0;
+	#endif
+}
+
+void* InitBlock(void* ptr, size_t size, size_t alignment, uint16_t blockThreadIndex, MemTag tag)
+{
+	ION_ASSERT(ion::IsPowerOfTwo(alignment) && alignment >= 8 && alignment <= (size_t(8) << 15), "Invalid alignment");
 	void* userPtr = AlignAddress(static_cast<BlockHeader*>(ptr) + 1, alignment);
 	size_t offset(reinterpret_cast<char*>(userPtr) - reinterpret_cast<char*>(ptr));
 
@@ -158,7 +189,8 @@ void* InitBlock(void* ptr, size_t size, size_t alignment, uint16_t blockThreadIn
 	headerPtr->mOffset = ion::SafeRangeCast<uint8_t>(offset);
 
 	headerPtr->mThreadId = blockThreadIndex;
-	headerPtr->mAlignment = ion::SafeRangeCast<uint8_t>(alignment / 8);
+	headerPtr->mAlignmentShift = uint8_t(ion::CountTrailingZeroes(alignment / 8));
+	headerPtr->mTag = uint8_t(tag);
 	return userPtr;
 }
 
@@ -168,6 +200,40 @@ static Pool* gPool;
 static std::atomic<int64_t> gNumAllocations;
 	#endif
 
+void* AllocateBlock(UInt index, size_t size, size_t alignment, MemTag tag)
+{
+	ION_ASSERT_FMT_IMMEDIATE(alignment >= sizeof(BlockHeader), "Invalid alignment");
+	size_t allocationSize = size + alignment;
+	void* ptr;
+
+	UInt blockThreadIndex = index;
+
+	if (size <= MaxGlobalMemoryBlockSize && index != UInt(-1))
+	{
+		UInt elemIndex = index % NumElemsPerBucket;
+		UInt bucketIndex = index / NumElemsPerBucket;
+
+		gPool->mTlPool[bucketIndex]->mResources[elemIndex]->ProcessDeferDeallocations();
+		ptr = gPool->mTlPool[bucketIndex]->mResources[elemIndex]->Allocate(allocationSize);
+	#if ION_CLEAN_EXIT
+		gNumAllocations++;
+	#endif
+	}
+	else
+	{
+		ptr = ion::NativeMalloc(allocationSize);
+		blockThreadIndex = UInt(-1);
+	}
+	if (!ptr)
+	{
+		NotifyOutOfMemory();
+		return nullptr;
+	}
+
+	memory_accounting::OnAllocation(index, tag, size);
+	return InitBlock(ptr, size, alignment, uint16_t(blockThreadIndex), tag);
+}
+
 }  // namespace
 
 void GlobalMemoryInit()
@@ -193,7 +259,7 @@ void GlobalMemoryThreadInit(UInt index)
 
 	if (!gPool->mTlPool[bucketIndex]->mResources[elemIndex])
 	{
-		gPool->mTlPool[bucketIndex]->mResources[elemIndex] = Construct<Resource>();
+		gPool->mTlPool[bucketIndex]->mResources[elemIndex] = Construct<Resource, ResourceAllocator<Resource>>();
 	}
 }
 
@@ -243,35 +309,7 @@ void GlobalMemoryDeinit()
 
 void* GlobalMemoryAllocate(UInt index, size_t size, size_t alignment)
 {
-	ION_ASSERT_FMT_IMMEDIATE(alignment >= sizeof(BlockHeader), "Invalid alignment");
-	size_t allocationSize = size + alignment;
-	void* ptr;
-
-	UInt blockThreadIndex = index;
-
-	if (size <= MaxGlobalMemoryBlockSize && index != UInt(-1))
-	{
-		UInt elemIndex = index % NumElemsPerBucket;
-		UInt bucketIndex = index / NumElemsPerBucket;
-
-		gPool->mTlPool[bucketIndex]->mResources[elemIndex]->ProcessDeferDeallocations();
-		ptr = gPool->mTlPool[bucketIndex]->mResources[elemIndex]->Allocate(allocationSize);
-	#if ION_CLEAN_EXIT
-		gNumAllocations++;
-	#endif
-	}
-	else
-	{
-		ptr = ion::NativeMalloc(allocationSize);
-		blockThreadIndex = UInt(-1);
-	}
-	if (!ptr)
-	{
-		NotifyOutOfMemory();
-		return nullptr;
-	}
-
-	return InitBlock(ptr, size, alignment, uint16_t(blockThreadIndex));
+	return AllocateBlock(index, size, alignment, CurrentTag());
 }
 
 void GlobalMemoryDeallocate(UInt index, void* userPtr)
@@ -281,6 +319,7 @@ void GlobalMemoryDeallocate(UInt index, void* userPtr)
 		return;
 	}
 	BlockHeader* headerPtr = static_cast<BlockHeader*>(userPtr) - 1;
+	memory_accounting::OnDeallocation(index, headerPtr->Tag(), headerPtr->mSize);
 	void* ptr = static_cast<char*>(userPtr) - headerPtr->mOffset;
 	if (headerPtr->mThreadId == uint16_t(-1))
 	{
@@ -318,18 +357,22 @@ void* GlobalMemoryReallocate(UInt threadIndex, void* userPtr, size_t size)
 {
 	BlockHeader* headerPtr = static_cast<BlockHeader*>(userPtr) - 1;
 	void* ptr = static_cast<char*>(userPtr) - headerPtr->mOffset;
-	uint8_t alignment = headerPtr->mAlignment;
-	ION_ASSERT_FMT_IMMEDIATE(headerPtr->mAlignment * 8 <= 16, "Invalid alignment for realloc");
+	size_t alignment = headerPtr->Alignment();
+	ION_ASSERT_FMT_IMMEDIATE(alignment <= 16, "Invalid alignment for realloc");
+	// Reallocated block keeps its memory tag
+	MemTag tag = headerPtr->Tag();
+	size_t oldSize = headerPtr->mSize;
 	if (headerPtr->mThreadId == uint16_t(-1))
 	{
-		threadIndex = uint16_t(-1);
 		ptr = ion::NativeRealloc(ptr, size + alignment);
 		if (!ptr)
 		{
 			NotifyOutOfMemory();
 			return nullptr;
 		}
-		userPtr = InitBlock(ptr, size, alignment * 8, uint16_t(-1));
+		memory_accounting::OnDeallocation(threadIndex, tag, oldSize);
+		memory_accounting::OnAllocation(threadIndex, tag, size);
+		userPtr = InitBlock(ptr, size, alignment, uint16_t(-1), tag);
 	}
 	else
 	{
@@ -345,18 +388,19 @@ void* GlobalMemoryReallocate(UInt threadIndex, void* userPtr, size_t size)
 				NotifyOutOfMemory();
 				return nullptr;
 			}
-			userPtr = InitBlock(ptr, size, alignment * 8, uint16_t(threadIndex));
+			memory_accounting::OnDeallocation(threadIndex, tag, oldSize);
+			memory_accounting::OnAllocation(threadIndex, tag, size);
+			userPtr = InitBlock(ptr, size, alignment, uint16_t(threadIndex), tag);
 		}
 		else
 		{
-			size_t oldBlockSize = headerPtr->mSize;
-			void* newUserPtr = GlobalMemoryAllocate(threadIndex, size, alignment * 8);
+			void* newUserPtr = AllocateBlock(threadIndex, size, alignment, tag);
 			if (!newUserPtr)
 			{
 				NotifyOutOfMemory();
 				return nullptr;
 			}
-			memcpy((char*)newUserPtr, (char*)userPtr, oldBlockSize);
+			memcpy((char*)newUserPtr, (char*)userPtr, ion::Min(oldSize, size));
 			GlobalMemoryDeallocate(threadIndex, userPtr);
 			userPtr = newUserPtr;
 		}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ion/memory/HugePageAllocator.h>
+
+#include <ion/debug/MemoryTracker.h>
+
+#include <ion/util/Math.h>
+
+#if ION_PLATFORM_MICROSOFT
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <Windows.h>
+#elif ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	#include <sys/mman.h>
+#endif
+
+namespace ion::huge_pages
+{
+namespace
+{
+// Blocks of this size are mapped from operating system. Size is known also when deallocating, thus no block header is needed
+// and page sized blocks map exactly to huge pages.
+[[nodiscard]] inline bool IsMapped(size_t size) { return size >= PageSize / 2; }
+
+[[nodiscard]] inline size_t MappedSize(size_t size) { return ion::ByteAlignPosition(size, PageSize); }
+
+void* OsAllocateHugePages(size_t size)
+{
+#if ION_PLATFORM_MICROSOFT
+	static const size_t largePageMinimum = GetLargePageMinimum();
+	if (largePageMinimum != 0 && size % largePageMinimum == 0)
+	{
+		// Fails without SeLockMemoryPrivilege
+		if (void* ptr = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE))
+		{
+			return ptr;
+		}
+	}
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	// Over-allocate and trim so that mapping starts at huge page boundary, otherwise kernel cannot use huge page for the first
+	// and last partial huge pages.
+	const size_t mappedSize = size + PageSize;
+	uint8_t* ptr = reinterpret_cast<uint8_t*>(mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (ptr == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	uint8_t* aligned = ion::AlignAddress(ptr, PageSize);
+	size_t head = size_t(aligned - ptr);
+	if (head > 0)
+	{
+		munmap(ptr, head);
+	}
+	size_t tail = mappedSize - head - size;
+	if (tail > 0)
+	{
+		munmap(aligned + size, tail);
+	}
+	#if defined(MADV_HUGEPAGE)
+	// Only a hint, transparent huge pages may be disabled
+	madvise(aligned, size, MADV_HUGEPAGE);
+	#endif
+	return aligned;
+#else
+	return ion::NativeAlignedMalloc(size, MaxAlignment);
+#endif
+}
+
+void OsFree(void* ptr, [[maybe_unused]] size_t size)
+{
+#if ION_PLATFORM_MICROSOFT
+	if (!VirtualFree(ptr, 0, MEM_RELEASE))
+	{
+		ION_ASSERT_FMT_IMMEDIATE(false, "failed to free huge pages");
+	}
+#elif ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	if (munmap(ptr, size) != 0)
+	{
+		ION_ASSERT_FMT_IMMEDIATE(false, "failed to free huge pages");
+	}
+#else
+	ion::NativeAlignedFree(ptr);
+#endif
+}
+}  // namespace
+
+void* Allocate(size_t size)
+{
+	if (!IsMapped(size))
+	{
+		return ion::NativeAlignedMalloc(size, MaxAlignment);
+	}
+	const size_t mappedSize = MappedSize(size);
+	void* ptr = OsAllocateHugePages(mappedSize);
+	if (ptr)
+	{
+		memory_tracker::TrackStatic(uint32_t(mappedSize), ion::tag::External);
+	}
+	return ptr;
+}
+
+void Deallocate(void* p, size_t size)
+{
+	if (p == nullptr)
+	{
+		return;
+	}
+	if (!IsMapped(size))
+	{
+		ion::NativeAlignedFree(p);
+	}
+	else
+	{
+		const size_t mappedSize = MappedSize(size);
+		memory_tracker::UntrackStatic(uint32_t(mappedSize), ion::tag::External);
+		OsFree(p, mappedSize);
+	}
+}
+
+}  // namespace ion::huge_pages
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/memory/Memory.h>
+
+namespace ion
+{
+namespace huge_pages
+{
+// Maximum alignment of huge page allocations
+constexpr size_t MaxAlignment = ION_CONFIG_CACHE_LINE_SIZE;
+
+// Huge page size. Allocations of at least half of this are mapped using huge pages.
+constexpr size_t PageSize = size_t(2) * 1024 * 1024;
+
+// Allocates memory backed by huge pages when operating system allows it. Linux uses transparent huge pages, Windows uses
+// large pages if process has SeLockMemoryPrivilege. Blocks of at least half of huge page are mapped directly from operating
+// system and rounded up to multiple of huge page, regular pages are used when huge pages are not available. Smaller blocks
+// are allocated using native allocator.
+ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* Allocate(size_t size);
+
+// Size must be the size given to Allocate()
+void Deallocate(void* p, size_t size);
+}  // namespace huge_pages
+
+// Allocator for large blocks that are accessed randomly, huge pages reduce TLB misses.
+template <typename T>
+class HugePageAllocator
+{
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using difference_type = ptrdiff_t;
+
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::false_type;
+
+	template <class U>
+	struct rebind
+	{
+		using other = HugePageAllocator<U>;
+	};
+	using is_always_equal = std::true_type;
+
+	HugePageAllocator() {}
+
+	template <class U>
+	HugePageAllocator(const HugePageAllocator<U>&)
+	{
+	}
+
+	template <typename Source>
+	HugePageAllocator([[maybe_unused]] Source* const source)
+	{
+		ION_ASSERT_FMT_IMMEDIATE(source == nullptr, "HugePageAllocator does not use resources");
+	}
+
+	[[nodiscard]] inline T* AllocateRaw(size_type numBytes)
+	{
+		static_assert(alignof(T) <= huge_pages::MaxAlignment, "Unsupported alignment");
+		return ion::AssumeAligned(reinterpret_cast<T*>(huge_pages::Allocate(numBytes)));
+	}
+
+	[[nodiscard]] inline T* AllocateRaw(size_type numBytes, [[maybe_unused]] size_t alignment)
+	{
+		ION_ASSERT(alignment <= huge_pages::MaxAlignment, "Unsupported alignment");
+		return ion::AssumeAligned(reinterpret_cast<T*>(huge_pages::Allocate(numBytes)));
+	}
+
+	inline void DeallocateRaw(void* p, size_type numBytes) { huge_pages::Deallocate(p, numBytes); }
+
+	inline void DeallocateRaw(void* p, size_type numBytes, size_t /*alignment*/) { huge_pages::Deallocate(p, numBytes); }
+
+	// STL support
+	[[nodiscard]] T* allocate(size_type num) { return AllocateRaw(num * sizeof(T)); }
+	void deallocate(T* p, size_type num) { DeallocateRaw(p, sizeof(T) * num); }
+};
+
+template <class T1, class T2>
+constexpr bool operator==(const ion::HugePageAllocator<T1>&, const ion::HugePageAllocator<T2>&)
+{
+	return true;
+}
+
+template <class T1, class T2>
+constexpr bool operator!=(const ion::HugePageAllocator<T1>&, const ion::HugePageAllocator<T2>&)
+{
+	return false;
+}
+
+}  // namespace ion
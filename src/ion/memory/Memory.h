@@ -88,7 +88,7 @@ const MemTag NodeGraph = 14;
 const MemTag Debug = 15;
 const MemTag Count = 16;
 
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 inline const char* Name(MemTag tag)
 {
 	switch (tag)
@@ -139,9 +139,11 @@ inline const char* Name(MemTag tag)
 namespace detail
 {
 
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 uint16_t GetMemoryTag();
+#endif
 
+#if ION_MEMORY_TRACKER
 ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* TrackedNativeAlignedMalloc(size_t size, size_t alignment, MemTag tag);
 ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* TrackedNativeAlignedRealloc(void* ptr, size_t size, size_t oldSize, size_t alignment,
 																		  MemTag tag);
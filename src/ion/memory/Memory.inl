@@ -17,6 +17,7 @@
 #include <ion/container/Array.h>
 #include <ion/container/UnorderedMap.h>
 
+#include <ion/debug/HeapProfiler.h>
 #include <ion/debug/MemoryTracker.h>
 #include <ion/debug/Profiling.h>
 
@@ -77,25 +78,31 @@ ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* Malloc(size_t size,
 {
 	ION_PROFILER_SCOPE(Memory, "Memory alloc");
 #if ION_CONFIG_GLOBAL_MEMORY_POOL
-	return GlobalMemoryAllocate(Thread::GetId(), size, alignment);
+	void* ptr = GlobalMemoryAllocate(Thread::GetId(), size, alignment);
 #else
-	return ion::NativeAlignedMalloc(size, alignment);
+	void* ptr = ion::NativeAlignedMalloc(size, alignment);
 #endif
+	ion::heap_profiler::OnAllocation(ptr, size);
+	return ptr;
 }
 
 ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* Realloc(void* ptr, size_t size)
 {
 	ION_PROFILER_SCOPE(Memory, "Memory realloc");
+	ion::heap_profiler::OnDeallocation(ptr);
 #if ION_CONFIG_GLOBAL_MEMORY_POOL
-	return GlobalMemoryReallocate(Thread::GetId(), ptr, size);
+	void* newPtr = GlobalMemoryReallocate(Thread::GetId(), ptr, size);
 #else
-	return ion::NativeRealloc(ptr, size);
+	void* newPtr = ion::NativeRealloc(ptr, size);
 #endif
+	ion::heap_profiler::OnAllocation(newPtr, size);
+	return newPtr;
 }
 
 void Free(void* ptr)
 {
 	ION_PROFILER_SCOPE(Memory, "Memory free");
+	ion::heap_profiler::OnDeallocation(ptr);
 #if ION_CONFIG_GLOBAL_MEMORY_POOL
 	GlobalMemoryDeallocate(Thread::GetId(), ptr);
 #else
@@ -156,8 +163,7 @@ ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* NativeAlignedRealloc(void* ptr, si
 	return newPtr;
 }
 
-#if ION_MEMORY_TRACKER
-
+#if ION_MEMORY_TAGS
 uint16_t GetMemoryTag()
 {
 	if (ion::Thread::GetCurrentJob() == nullptr)
@@ -166,6 +172,9 @@ uint16_t GetMemoryTag()
 	}
 	return ion::Thread::GetCurrentJob()->Tag();
 }
+#endif
+
+#if ION_MEMORY_TRACKER
 
 ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* TrackedMalloc(size_t size, size_t alignment, MemTag tag)
 {
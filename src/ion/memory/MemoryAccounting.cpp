@@ -0,0 +1,89 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ion/memory/MemoryAccounting.h>
+
+#if ION_MEMORY_ACCOUNTING
+	#include <ion/container/Array.h>
+
+	#include <ion/tracing/Log.h>
+
+	#include <cinttypes>
+
+namespace ion::memory_accounting
+{
+namespace detail
+{
+Shard gShards[NumThreadShards + 1] = {};
+}  // namespace detail
+
+void Usage(TagUsage* usage)
+{
+	TagUsage& total = usage[tag::Count];
+	total = TagUsage();
+	for (MemTag i = 0; i < tag::Count; ++i)
+	{
+		usage[i] = Usage(i);
+		total.mBytes += usage[i].mBytes;
+		total.mBlocks += usage[i].mBlocks;
+		total.mAllocatedBytes += usage[i].mAllocatedBytes;
+		total.mAllocatedBlocks += usage[i].mAllocatedBlocks;
+	}
+}
+
+TagUsage Usage(MemTag tag)
+{
+	ION_ASSERT(tag < tag::Count, "Invalid memory tag");
+	TagUsage usage;
+	for (UInt i = 0; i <= detail::NumThreadShards; ++i)
+	{
+		const detail::Counters& counters = detail::gShards[i].mCounters[tag];
+		usage.mBytes += counters.mBytes.load(std::memory_order_relaxed);
+		usage.mBlocks += counters.mBlocks.load(std::memory_order_relaxed);
+		usage.mAllocatedBytes += counters.mAllocatedBytes.load(std::memory_order_relaxed);
+		usage.mAllocatedBlocks += counters.mAllocatedBlocks.load(std::memory_order_relaxed);
+	}
+	return usage;
+}
+
+void PrintUsage()
+{
+	ion::Array<TagUsage, tag::Count + 1> usage;
+	Usage(usage.Data());
+	for (MemTag i = 0; i <= tag::Count; ++i)
+	{
+		if (usage[i].mAllocatedBlocks > 0)
+		{
+			ION_LOG_INFO_FMT("Memory[%s] %" PRId64 " bytes in use (%" PRId64 " blocks); %" PRIu64 " bytes allocated (%" PRIu64 " blocks)",
+							 ion::tag::Name(i), usage[i].mBytes, usage[i].mBlocks, usage[i].mAllocatedBytes,
+							 usage[i].mAllocatedBlocks);
+		}
+	}
+}
+}  // namespace ion::memory_accounting
+#else
+namespace ion::memory_accounting
+{
+void Usage(TagUsage* usage)
+{
+	for (MemTag i = 0; i <= tag::Count; ++i)
+	{
+		usage[i] = TagUsage();
+	}
+}
+TagUsage Usage(MemTag) { return TagUsage(); }
+void PrintUsage() {}
+}  // namespace ion::memory_accounting
+#endif
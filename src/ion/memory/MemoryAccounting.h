@@ -0,0 +1,123 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/memory/Memory.h>
+
+#if ION_MEMORY_ACCOUNTING
+	#include <atomic>
+#endif
+
+namespace ion
+{
+// Always-on memory accounting of global memory pool per memory tag.
+//
+// Counters are sharded per thread and aggregated only when usage is queried. Threads with own shard update their counters
+// without atomic read-modify-write operations, other threads share a single shard. Memory tag of a block is stored to global
+// memory pool block header, thus accounting does not add any per-block metadata. Unlike memory tracker, accounting does not
+// detect leaks or invalid frees, it only keeps totals to be exported as production metrics.
+namespace memory_accounting
+{
+struct TagUsage
+{
+	int64_t mBytes = 0;
+	int64_t mBlocks = 0;
+	uint64_t mAllocatedBytes = 0;
+	uint64_t mAllocatedBlocks = 0;
+};
+
+#if ION_MEMORY_ACCOUNTING
+namespace detail
+{
+constexpr UInt NumThreadShards = 64;
+
+struct Counters
+{
+	std::atomic<int64_t> mBytes;
+	std::atomic<int64_t> mBlocks;
+	std::atomic<uint64_t> mAllocatedBytes;
+	std::atomic<uint64_t> mAllocatedBlocks;
+};
+
+struct ION_ALIGN_CACHE_LINE Shard
+{
+	Counters mCounters[tag::Count];
+};
+
+// Thread shards followed by shared shard
+extern Shard gShards[NumThreadShards + 1];
+
+template <typename T>
+inline void Add(std::atomic<T>& counter, T value)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+}  // namespace detail
+
+inline void OnAllocation(UInt threadIndex, MemTag tag, size_t size)
+{
+	ION_ASSERT(tag < tag::Count, "Invalid memory tag");
+	if ION_LIKELY (threadIndex < detail::NumThreadShards)
+	{
+		detail::Counters& counters = detail::gShards[threadIndex].mCounters[tag];
+		detail::Add(counters.mBytes, static_cast<int64_t>(size));
+		detail::Add(counters.mBlocks, int64_t(1));
+		detail::Add(counters.mAllocatedBytes, static_cast<uint64_t>(size));
+		detail::Add(counters.mAllocatedBlocks, uint64_t(1));
+	}
+	else
+	{
+		detail::Counters& counters = detail::gShards[detail::NumThreadShards].mCounters[tag];
+		counters.mBytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+		counters.mBlocks.fetch_add(1, std::memory_order_relaxed);
+		counters.mAllocatedBytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+		counters.mAllocatedBlocks.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+// Block can be freed by any thread, only totals of all shards are meaningful.
+inline void OnDeallocation(UInt threadIndex, MemTag tag, size_t size)
+{
+	ION_ASSERT(tag < tag::Count, "Invalid memory tag");
+	if ION_LIKELY (threadIndex < detail::NumThreadShards)
+	{
+		detail::Counters& counters = detail::gShards[threadIndex].mCounters[tag];
+		detail::Add(counters.mBytes, -static_cast<int64_t>(size));
+		detail::Add(counters.mBlocks, int64_t(-1));
+	}
+	else
+	{
+		detail::Counters& counters = detail::gShards[detail::NumThreadShards].mCounters[tag];
+		counters.mBytes.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+		counters.mBlocks.fetch_sub(1, std::memory_order_relaxed);
+	}
+}
+#else
+inline void OnAllocation(UInt, MemTag, size_t) {}
+
+inline void OnDeallocation(UInt, MemTag, size_t) {}
+#endif
+
+// Aggregates usage of all threads. 'usage' must have room for tag::Count + 1 entries, last entry will contain total of all
+// tags. Counters are read without synchronization, thus result is only a snapshot of usage while other threads are running.
+void Usage(TagUsage* usage);
+
+TagUsage Usage(MemTag tag);
+
+void PrintUsage();
+
+}  // namespace memory_accounting
+}  // namespace ion
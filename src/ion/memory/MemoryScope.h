@@ -16,7 +16,7 @@
 #pragma once
 
 #include <ion/memory/Memory.h>
-#if ION_MEMORY_TRACKER
+#if ION_MEMORY_TAGS
 	#include <ion/concurrency/Thread.h>
 	#include <ion/jobs/BaseJob.h>
 
@@ -138,6 +138,34 @@ public:
 		mProxy.mActiveBlock = startBlock;
 	}
 
+	struct Position
+	{
+		detail::MemoryBufferBlock* mBlock;
+		size_t mSize;
+	};
+
+	Position CurrentPosition() const { return Position{mProxy.mActiveBlock, mProxy.mActiveBlock->size}; }
+
+	// Rewinds to position returned by CurrentPosition(). Blocks after active block are always empty, thus only blocks used after
+	// the position need to be cleared.
+	void Rewind(const Position& position)
+	{
+		detail::MemoryBufferBlock* ptr = position.mBlock;
+		while (ptr != mProxy.mActiveBlock)
+		{
+			ptr = ptr->next;
+#if ION_BUILD_DEBUG
+			std::memset(&ptr->data, 0xCD, ptr->size);
+#endif
+			ptr->size = 0;
+		}
+#if ION_BUILD_DEBUG
+		std::memset(&position.mBlock->data + position.mSize, 0xCD, position.mBlock->size - position.mSize);
+#endif
+		position.mBlock->size = position.mSize;
+		mProxy.mActiveBlock = position.mBlock;
+	}
+
 	void RewindAndDeallocate(detail::MemoryBufferBlock* startBlock)
 	{
 		detail::MemoryBufferBlock* ptr = startBlock;
@@ -173,7 +201,11 @@ public:
 		return newBlock;
 	}
 
-	void DeallocateBlock(detail::MemoryBufferBlock* block) { mProxy.deallocate(block, 0); }
+	void DeallocateBlock(detail::MemoryBufferBlock* block)
+	{
+		// Same count as in AllocateBlock(), allocators may need size to free the block
+		mProxy.deallocate(block, (block->capacity + detail::MemoryBufferBlock::HeaderSize) / sizeof(detail::MemoryBufferBlock));
+	}
 
 private:
 	void* AllocateFromBlock(detail::MemoryBufferBlock& block, size_t len, size_t alignment)
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <ion/memory/NumaAllocator.h>
+
+#include <ion/debug/MemoryTracker.h>
+
+#include <ion/util/Math.h>
+#include <ion/util/OsInfo.h>
+
+#if ION_PLATFORM_MICROSOFT
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <Windows.h>
+#elif ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+namespace ion::numa
+{
+namespace
+{
+// Blocks of this size are mapped from operating system when NUMA is available. Size is known also when deallocating, thus
+// no block header is needed and payload is page aligned.
+[[nodiscard]] inline bool IsMapped(size_t size) { return IsAvailable() && size >= ion::OsMemoryPageSize() / 2; }
+
+[[nodiscard]] inline size_t MappedSize(size_t size) { return ion::ByteAlignPosition(size, ion::OsMemoryPageSize()); }
+
+#if ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+// MPOL_PREFERRED from linux/mempolicy.h. Preferred policy falls back to other nodes when node is out of memory.
+constexpr int MemoryPolicyPreferred = 1;
+#endif
+
+void* OsAllocateOnNode(size_t size, [[maybe_unused]] UInt node)
+{
+#if ION_PLATFORM_MICROSOFT
+	return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, DWORD(node));
+#elif ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (ptr == MAP_FAILED)
+	{
+		return nullptr;
+	}
+	#if defined(SYS_mbind)
+	if (node < sizeof(unsigned long) * 8)
+	{
+		// Binding is done before first touch, pages will be placed to node when they are touched first time
+		unsigned long nodeMask = 1ul << node;
+		[[maybe_unused]] long res = syscall(SYS_mbind, ptr, size, MemoryPolicyPreferred, &nodeMask, sizeof(nodeMask) * 8, 0);
+		ION_ASSERT(res == 0, "mbind failed");
+	}
+	#endif
+	return ptr;
+#else
+	return nullptr;
+#endif
+}
+
+void OsFree(void* ptr, [[maybe_unused]] size_t size)
+{
+#if ION_PLATFORM_MICROSOFT
+	if (!VirtualFree(ptr, 0, MEM_RELEASE))
+	{
+		ION_ASSERT_FMT_IMMEDIATE(false, "failed to free NUMA memory");
+	}
+#elif ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	if (munmap(ptr, size) != 0)
+	{
+		ION_ASSERT_FMT_IMMEDIATE(false, "failed to free NUMA memory");
+	}
+#endif
+}
+}  // namespace
+
+bool IsAvailable()
+{
+#if ION_CONFIG_NUMA
+	static const bool isAvailable = ion::OsNumaNodeCount() > 1;
+	return isAvailable;
+#else
+	return false;
+#endif
+}
+
+UInt CurrentNode() { return IsAvailable() ? ion::OsNumaNode() : 0; }
+
+void* Allocate(size_t size, UInt node)
+{
+	if (!IsMapped(size))
+	{
+		return ion::NativeAlignedMalloc(size, MaxAlignment);
+	}
+	const size_t mappedSize = MappedSize(size);
+	void* ptr = OsAllocateOnNode(mappedSize, node);
+	if (ptr)
+	{
+		memory_tracker::TrackStatic(uint32_t(mappedSize), ion::tag::External);
+	}
+	return ptr;
+}
+
+void Deallocate(void* p, size_t size)
+{
+	if (p == nullptr)
+	{
+		return;
+	}
+	if (!IsMapped(size))
+	{
+		ion::NativeAlignedFree(p);
+	}
+	else
+	{
+		const size_t mappedSize = MappedSize(size);
+		memory_tracker::UntrackStatic(uint32_t(mappedSize), ion::tag::External);
+		OsFree(p, mappedSize);
+	}
+}
+
+}  // namespace ion::numa
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/memory/Memory.h>
+
+namespace ion
+{
+namespace numa
+{
+// Maximum alignment of NUMA allocations
+constexpr size_t MaxAlignment = ION_CONFIG_CACHE_LINE_SIZE;
+
+// True when system has more than one memory node
+bool IsAvailable();
+
+// Memory node of the processor running calling thread. Always 0 when NUMA is not available.
+UInt CurrentNode();
+
+// Allocates memory from given node. Blocks of at least half of memory page are mapped directly from operating system and
+// rounded up to memory pages. Smaller blocks, and all blocks when NUMA is not available, are allocated using native
+// allocator.
+ION_RESTRICT_RETURN_VALUE [[nodiscard]] void* Allocate(size_t size, UInt node);
+
+// Size must be the size given to Allocate()
+void Deallocate(void* p, size_t size);
+}  // namespace numa
+
+// Allocator placing memory to a NUMA node. By default node is the node of the processor that constructed the allocator.
+// Any NUMA allocator can deallocate memory of other NUMA allocators.
+template <typename T>
+class NumaAllocator
+{
+	template <typename U>
+	friend class NumaAllocator;
+
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using difference_type = ptrdiff_t;
+
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::true_type;
+	using propagate_on_container_swap = std::false_type;
+
+	template <class U>
+	struct rebind
+	{
+		using other = NumaAllocator<U>;
+	};
+	using is_always_equal = std::true_type;
+
+	NumaAllocator() : mNode(numa::CurrentNode()) {}
+	explicit NumaAllocator(UInt node) : mNode(node) {}
+	NumaAllocator(const NumaAllocator& other) : mNode(other.mNode) {}
+	NumaAllocator(NumaAllocator&& other) : mNode(other.mNode) {}
+	NumaAllocator& operator=(NumaAllocator&& other)
+	{
+		mNode = other.mNode;
+		return *this;
+	}
+	NumaAllocator& operator=(const NumaAllocator& other)
+	{
+		mNode = other.mNode;
+		return *this;
+	}
+
+	template <class U>
+	NumaAllocator(const NumaAllocator<U>& other) : mNode(other.mNode)
+	{
+	}
+
+	template <typename Source>
+	NumaAllocator([[maybe_unused]] Source* const source) : mNode(numa::CurrentNode())
+	{
+		ION_ASSERT_FMT_IMMEDIATE(source == nullptr, "NumaAllocator does not use resources");
+	}
+
+	~NumaAllocator() {}
+
+	UInt Node() const { return mNode; }
+
+	[[nodiscard]] inline T* AllocateRaw(size_type numBytes)
+	{
+		static_assert(alignof(T) <= numa::MaxAlignment, "Unsupported alignment");
+		return ion::AssumeAligned(reinterpret_cast<T*>(numa::Allocate(numBytes, mNode)));
+	}
+
+	[[nodiscard]] inline T* AllocateRaw(size_type numBytes, [[maybe_unused]] size_t alignment)
+	{
+		ION_ASSERT(alignment <= numa::MaxAlignment, "Unsupported alignment");
+		return ion::AssumeAligned(reinterpret_cast<T*>(numa::Allocate(numBytes, mNode)));
+	}
+
+	inline void DeallocateRaw(void* p, size_type numBytes) { numa::Deallocate(p, numBytes); }
+
+	inline void DeallocateRaw(void* p, size_type numBytes, size_t /*alignment*/) { numa::Deallocate(p, numBytes); }
+
+	// STL support
+	[[nodiscard]] T* allocate(size_type num) { return AllocateRaw(num * sizeof(T)); }
+	void deallocate(T* p, size_type num) { DeallocateRaw(p, sizeof(T) * num); }
+
+	void deallocate(void* p, size_type num) { DeallocateRaw(p, num); }
+
+private:
+	UInt mNode;
+};
+
+template <class T1, class T2>
+constexpr bool operator==(const ion::NumaAllocator<T1>&, const ion::NumaAllocator<T2>&)
+{
+	return true;
+}
+
+template <class T1, class T2>
+constexpr bool operator!=(const ion::NumaAllocator<T1>&, const ion::NumaAllocator<T2>&)
+{
+	return false;
+}
+
+}  // namespace ion
@@ -75,16 +75,11 @@ public:
 	T* Acquire(Args&&... args)
 	{
 		ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
-		if (!mFreeObjects)
+		Node* node = AcquireFreeNode();
+		if (!node)
 		{
-			AllocteFreeObjects(mAllocationSize);
-			if (!mFreeObjects)
-			{
-				return nullptr;
-			}
-			mAllocationSize = ion::Min(mMaxAllocationSize, mAllocationSize * 2);
+			return nullptr;
 		}
-		Node* node = AcquireNode();
 		node->payload.data.Insert(0, std::forward<Args>(args)...);
 		return &node->payload.data[0];
 	}
@@ -97,6 +92,21 @@ public:
 		ReleaseNode(node);
 	}
 
+	// Returns storage for an object without constructing it. Storage must be given back using ReleaseRaw().
+	T* AcquireRaw()
+	{
+		ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
+		Node* node = AcquireFreeNode();
+		return node ? &node->payload.data[0] : nullptr;
+	}
+
+	// Returns storage of an object that is already destroyed.
+	void ReleaseRaw(T* obj)
+	{
+		ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
+		ReleaseNode(reinterpret_cast<Node*>(obj));
+	}
+
 	void Purge()
 	{
 		ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
@@ -122,6 +132,20 @@ private:
 	size_t mTotalAllocations = 0;
 #endif
 
+	inline Node* AcquireFreeNode()
+	{
+		if (!mFreeObjects)
+		{
+			AllocteFreeObjects(mAllocationSize);
+			if (!mFreeObjects)
+			{
+				return nullptr;
+			}
+			mAllocationSize = ion::Min(mMaxAllocationSize, mAllocationSize * 2);
+		}
+		return AcquireNode();
+	}
+
 	inline Node* AcquireNode()
 	{
 		Node* node = mFreeObjects;
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <ion/memory/ObjectPool.h>
+#include <ion/concurrency/Mutex.h>
+#include <ion/concurrency/Thread.h>
+#include <ion/container/Array.h>
+#include <ion/jobs/SchedulerConfig.h>
+
+namespace ion
+{
+namespace detail
+{
+// Fixed size stack of free objects
+template <typename T, size_t Capacity>
+struct Magazine
+{
+	Magazine* mNext = nullptr;
+	size_t mCount = 0;
+	ion::Array<T*, Capacity> mItems;
+
+	inline bool IsEmpty() const { return mCount == 0; }
+	inline bool IsFull() const { return mCount == Capacity; }
+	inline void Push(T* item) { mItems[mCount++] = item; }
+	inline T* Pop() { return mItems[--mCount]; }
+};
+}  // namespace detail
+
+// Thread safe object pool using per-thread magazines.
+//
+// Each thread owns two magazines: fixed size stacks of free objects. Acquire() pops from and Release() pushes to the loaded
+// magazine without locking. Only when both magazines of a thread are empty (or full) the thread will lock the depot to exchange a
+// magazine, thus depot is accessed at most once every 'MagazineSize' calls. The depot keeps lists of full and empty magazines and
+// refills magazines from an object pool in batches.
+//
+// Threads are identified by ion::Thread::GetId(). Threads without id or with id beyond 'MaxThreadCaches' use the depot directly.
+template <typename T, typename Allocator = GlobalAllocator<T>, size_t MagazineSize = 32, UInt MaxThreadCaches = ion::MaxThreads>
+class ThreadSafeMagazinePool
+{
+	using Magazine = detail::Magazine<T, MagazineSize>;
+	using MagazineAllocator = typename Allocator::template rebind<Magazine>::other;
+
+	struct ThreadCache
+	{
+		ION_ALIGN_CACHE_LINE Magazine* mLoaded = nullptr;
+		Magazine* mPrevious = nullptr;
+	};
+
+public:
+	ION_CLASS_NON_COPYABLE_NOR_MOVABLE(ThreadSafeMagazinePool);
+
+	template <typename Resource>
+	ThreadSafeMagazinePool(Resource* source, size_t allocationSize, size_t maxAllocationSize = 0xFFFFFFFF)
+	  : mPool(source, allocationSize, maxAllocationSize), mMagazines(source, NumMagazinesPerAllocation(allocationSize))
+	{
+	}
+
+	ThreadSafeMagazinePool(size_t allocationSize, size_t maxAllocationSize = 0xFFFFFFFF)
+	  : mPool(allocationSize, maxAllocationSize), mMagazines(NumMagazinesPerAllocation(allocationSize))
+	{
+	}
+
+	~ThreadSafeMagazinePool()
+	{
+		ion::AutoLock<Mutex> lock(mMutex);
+		for (size_t i = 0; i < mCaches.Size(); ++i)
+		{
+			ReturnMagazine(mCaches[i].mLoaded);
+			ReturnMagazine(mCaches[i].mPrevious);
+		}
+		ReturnMagazines(mFullMagazines);
+		ReturnMagazines(mEmptyMagazines);
+	}
+
+	template <typename... Args>
+	T* Acquire(Args&&... args)
+	{
+		T* obj = AcquireRaw();
+		if (obj)
+		{
+			new (static_cast<void*>(obj)) T(std::forward<Args>(args)...);
+		}
+		return obj;
+	}
+
+	void Release(T* obj)
+	{
+		obj->~T();
+		ReleaseRaw(obj);
+	}
+
+private:
+	static constexpr size_t NumMagazinesPerAllocation(size_t allocationSize) { return ion::Max(size_t(4), allocationSize / MagazineSize); }
+
+	T* AcquireRaw()
+	{
+		ThreadCache* cache = LocalCache();
+		if ION_LIKELY (cache)
+		{
+			if ION_LIKELY (!cache->mLoaded->IsEmpty())
+			{
+				return cache->mLoaded->Pop();
+			}
+			if (cache->mPrevious->IsFull())
+			{
+				std::swap(cache->mLoaded, cache->mPrevious);
+				return cache->mLoaded->Pop();
+			}
+			return AcquireFromDepot(*cache);
+		}
+		ion::AutoLock<Mutex> lock(mMutex);
+		return mPool.AcquireRaw();
+	}
+
+	void ReleaseRaw(T* obj)
+	{
+		ThreadCache* cache = LocalCache();
+		if ION_LIKELY (cache)
+		{
+			if ION_LIKELY (!cache->mLoaded->IsFull())
+			{
+				cache->mLoaded->Push(obj);
+				return;
+			}
+			if (cache->mPrevious->IsEmpty())
+			{
+				std::swap(cache->mLoaded, cache->mPrevious);
+				cache->mLoaded->Push(obj);
+				return;
+			}
+			ReleaseToDepot(*cache, obj);
+			return;
+		}
+		ion::AutoLock<Mutex> lock(mMutex);
+		mPool.ReleaseRaw(obj);
+	}
+
+	// Loaded and previous magazines are both empty.
+	ION_NO_INLINE T* AcquireFromDepot(ThreadCache& cache)
+	{
+		ion::AutoLock<Mutex> lock(mMutex);
+		if (mFullMagazines)
+		{
+			Magazine* full = mFullMagazines;
+			mFullMagazines = full->mNext;
+			cache.mPrevious->mNext = mEmptyMagazines;
+			mEmptyMagazines = cache.mPrevious;
+			cache.mPrevious = cache.mLoaded;
+			cache.mLoaded = full;
+		}
+		else
+		{
+			while (!cache.mLoaded->IsFull())
+			{
+				T* obj = mPool.AcquireRaw();
+				if (!obj)
+				{
+					break;
+				}
+				cache.mLoaded->Push(obj);
+			}
+			if (cache.mLoaded->IsEmpty())
+			{
+				return nullptr;
+			}
+		}
+		return cache.mLoaded->Pop();
+	}
+
+	// Loaded and previous magazines are both full.
+	ION_NO_INLINE void ReleaseToDepot(ThreadCache& cache, T* obj)
+	{
+		ion::AutoLock<Mutex> lock(mMutex);
+		Magazine* empty = mEmptyMagazines;
+		if (empty)
+		{
+			mEmptyMagazines = empty->mNext;
+		}
+		else
+		{
+			empty = mMagazines.Acquire();
+			if (!empty)
+			{
+				mPool.ReleaseRaw(obj);
+				return;
+			}
+		}
+		cache.mPrevious->mNext = mFullMagazines;
+		mFullMagazines = cache.mPrevious;
+		cache.mPrevious = cache.mLoaded;
+		cache.mLoaded = empty;
+		cache.mLoaded->Push(obj);
+	}
+
+	inline ThreadCache* LocalCache()
+	{
+		UInt id = ion::Thread::GetId();
+		if ION_UNLIKELY (id >= MaxThreadCaches)
+		{
+			return nullptr;
+		}
+		ThreadCache* cache = &mCaches[id];
+		if ION_UNLIKELY (cache->mLoaded == nullptr)
+		{
+			return InitCache(*cache);
+		}
+		return cache;
+	}
+
+	ION_NO_INLINE ThreadCache* InitCache(ThreadCache& cache)
+	{
+		ion::AutoLock<Mutex> lock(mMutex);
+		Magazine* loaded = mMagazines.Acquire();
+		Magazine* previous = mMagazines.Acquire();
+		if (!loaded || !previous)
+		{
+			ReturnMagazine(loaded);
+			ReturnMagazine(previous);
+			return nullptr;
+		}
+		cache.mPrevious = previous;
+		cache.mLoaded = loaded;
+		return &cache;
+	}
+
+	// Depot must be locked
+	void ReturnMagazine(Magazine* magazine)
+	{
+		if (magazine)
+		{
+			while (!magazine->IsEmpty())
+			{
+				mPool.ReleaseRaw(magazine->Pop());
+			}
+			mMagazines.Release(magazine);
+		}
+	}
+
+	// Depot must be locked
+	void ReturnMagazines(Magazine*& list)
+	{
+		while (list)
+		{
+			Magazine* next = list->mNext;
+			ReturnMagazine(list);
+			list = next;
+		}
+	}
+
+	ion::Array<ThreadCache, MaxThreadCaches> mCaches;
+	ion::Mutex mMutex;
+	Magazine* mFullMagazines = nullptr;
+	Magazine* mEmptyMagazines = nullptr;
+	ObjectPool<T, Allocator> mPool;
+	ObjectPool<Magazine, MagazineAllocator> mMagazines;
+};
+
+}  // namespace ion
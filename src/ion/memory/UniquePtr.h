@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <ion/Types.h>
 #include <ion/memory/Memory.h>
 #include <type_traits>
 #include <new>
@@ -151,4 +152,10 @@ inline UniqueOpaquePtr<T> MakeUniqueOpaqueDomain(Args&&... args)
 	return UniqueOpaquePtr<T>(new (buffer) T(std::forward<Args>(args)...), &details::DefaultAllocatorDelete<Allocator>);
 }
 
+// Unique pointer holds only pointer and deleter
+template <class T, class Deleter>
+struct IsTriviallyRelocatable<std::unique_ptr<T, Deleter>> : IsTriviallyRelocatable<Deleter>
+{
+};
+
 }  // namespace ion
@@ -95,19 +95,30 @@ VirtualMemoryBuffer::~VirtualMemoryBuffer()
 	}
 }
 
-void* VirtualMemoryBuffer::Allocate(size_t len, size_t alignment)
+void* VirtualMemoryBuffer::TryAllocate(size_t len, size_t alignment)
 {
 	ION_ACCESS_GUARD_WRITE_BLOCK(mGuard);
 	if (mRootAddress)
 	{
 		void* ptr = ion::AlignAddress((char*)mRootAddress + mBytesUsed, alignment);
-		mBytesUsed = size_t((char*)ptr - (char*)mRootAddress) + len + alignment;
-		if (mBytesUsed <= mReservedBytes)
+		size_t bytesUsed = size_t((char*)ptr - (char*)mRootAddress) + len + alignment;
+		if (bytesUsed <= mReservedBytes)
 		{
+			mBytesUsed = bytesUsed;
 			OsAllocate(mRootAddress, mBytesUsed, true);
 			return ptr;
 		}
 	}
+	return nullptr;
+}
+
+void* VirtualMemoryBuffer::Allocate(size_t len, size_t alignment)
+{
+	void* ptr = TryAllocate(len, alignment);
+	if (ptr)
+	{
+		return ptr;
+	}
 
 	//ION_LOG_FMT_IMMEDIATE("Out of virtual space %zu/%zu", mBytesUsed, mReservedBytes);
 	GlobalAllocator<uint8_t> allocator;
@@ -124,6 +135,12 @@ void VirtualMemoryBuffer::Deallocate(void* ptr, size_t s)
 	}
 }
 
+void VirtualMemoryBuffer::Rewind(size_t position)
+{
+	ION_ASSERT(position <= mBytesUsed, "Invalid position");
+	mBytesUsed = position;
+}
+
 void* VirtualMemoryBuffer::Reallocate(void*, size_t)
 {
 	ION_ASSERT(false, "TODO");
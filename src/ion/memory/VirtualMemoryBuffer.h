@@ -16,6 +16,14 @@ public:
 	void* Reallocate(void* ptr, size_t);
 	void Deallocate(void* ptr, size_t);
 
+	// Allocates from reserved address space only, returns nullptr when out of reserved space.
+	void* TryAllocate(size_t len, size_t alignment);
+
+	size_t Position() const { return mBytesUsed; }
+
+	// Releases all allocations made after Position() returned 'position'. Committed pages are kept for reuse.
+	void Rewind(size_t position);
+
 private:
 	size_t mReservedBytes;
 	void* mRootAddress;
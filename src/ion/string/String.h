@@ -156,6 +156,15 @@ private:
 	NativeType mImpl;
 };
 
+// libc++ and MSVC standard strings without iterator debugging do not refer to themselves. libstdc++ short strings point to
+// internal buffer, thus they cannot be relocated.
+#if defined(_LIBCPP_VERSION) || (ION_PLATFORM_MICROSOFT && defined(_ITERATOR_DEBUG_LEVEL) && _ITERATOR_DEBUG_LEVEL == 0)
+template <typename TAllocator>
+struct IsTriviallyRelocatable<BasicString<TAllocator>> : IsTriviallyRelocatable<TAllocator>
+{
+};
+#endif
+
 }  // namespace ion
 #include <ion/string/StackString.h>
 namespace ion
@@ -349,6 +358,11 @@ int BasicString<TAllocator>::Format(Args&&... args)
 }
 
 
+template <>
+struct IsTriviallyRelocatable<String> : IsTriviallyRelocatable<BasicString<>>
+{
+};
+
 namespace serialization
 {
 template <>
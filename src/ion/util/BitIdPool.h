@@ -0,0 +1,408 @@
+/*
+ * Copyright 2023 Markus Haikonen, Ionhaken
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <ion/container/Vector.h>
+
+#include <ion/memory/GlobalAllocator.h>
+
+#include <ion/util/Bits.h>
+#include <ion/util/Math.h>
+
+#include <cstring>
+#include <memory>  // std::allocator_traits
+
+namespace ion
+{
+// Id pool that always reserves the lowest free id.
+//
+// Free ids are tracked in a hierarchical bitset: level 0 has a bit per id and each bit of an upper level tells if the
+// corresponding word of the level below has free ids. Lowest free id is found by descending the levels using count trailing
+// zeroes, thus reserve and free are O(log64 n). Reusing lowest ids keeps used ids compact, which keeps arrays indexed by ids
+// dense and ranges of used ids long.
+template <typename T, typename Allocator = ion::GlobalAllocator<T>>
+class BitIdPool
+{
+	using Word = uint64_t;
+	using WordAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Word>;
+
+	static constexpr size_t WordBits = 64;
+	static constexpr size_t WordShift = 6;
+	static constexpr size_t MaxLevels = 6;	// Enough for 2^36 ids
+
+public:
+	BitIdPool() {}
+
+	template <typename Resource>
+	explicit BitIdPool(Resource* resource) : mLevels{resource, resource, resource, resource, resource, resource}
+	{
+	}
+
+	void Reset()
+	{
+		for (size_t i = 0; i < MaxLevels; ++i)
+		{
+			mLevels[i].Clear();
+		}
+		mNumLevels = 0;
+		mTotalItems = 0;
+		mNumFree = 0;
+	}
+
+	// Id space in use, all used ids are less than Max()
+	T Max() const { return mTotalItems; }
+
+	T Size() const { return mTotalItems - mNumFree; }
+
+	bool HasFreeItems() const { return mNumFree != 0; }
+
+	bool IsFree(T id) const
+	{
+		ION_ASSERT(id < mTotalItems, "Invalid id");
+		return (mLevels[0][size_t(id) >> WordShift] & BitOf(size_t(id))) != 0;
+	}
+
+	T Reserve()
+	{
+		if (mNumFree == 0)
+		{
+			ION_ASSERT(static_cast<T>(mTotalItems + 1) != 0, "Out of id space");
+			Grow(mTotalItems + 1);
+			return mTotalItems++;
+		}
+		const size_t id = FindLowestFree();
+		ClearBit(id);
+		mNumFree--;
+		return T(id);
+	}
+
+	// Reserves 'count' lowest free ids to 'out' in ascending order
+	void Reserve(T* out, size_t count)
+	{
+		while (count > 0 && mNumFree != 0)
+		{
+			const size_t wordIndex = FindLowestFree() >> WordShift;
+			Word& word = mLevels[0][wordIndex];
+			Word taken = 0;
+			const size_t base = wordIndex << WordShift;
+			while (word != taken && count > 0)
+			{
+				const int bit = ion::CountTrailingZeroes<Word>(word & ~taken);
+				taken |= Word(1) << bit;
+				*out++ = T(base + size_t(bit));
+				count--;
+			}
+			word &= ~taken;
+			mNumFree -= T(ion::PopCount(taken));
+			if (word == 0)
+			{
+				ClearBit(wordIndex, 1);
+			}
+		}
+		if (count > 0)
+		{
+			T first = ReserveRange(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				*out++ = first + T(i);
+			}
+		}
+	}
+
+	// Reserves 'count' contiguous ids from the end of the id space. Returns first id.
+	T ReserveRange(size_t count)
+	{
+		const T first = mTotalItems;
+		ION_ASSERT(static_cast<T>(first + count) >= first, "Out of id space");
+		Grow(size_t(first) + count);
+		mTotalItems = T(first + count);
+		return first;
+	}
+
+	void Free(const T& id)
+	{
+		ION_ASSERT(id < mTotalItems, "Invalid id");
+		ION_ASSERT(!IsFree(id), "Duplicate free:" << id);
+		SetBit(size_t(id));
+		mNumFree++;
+	}
+
+	// Frees ids [first, first + count)
+	void FreeRange(T first, size_t count)
+	{
+		ION_ASSERT(size_t(first) + count <= size_t(mTotalItems), "Invalid range");
+		size_t pos = size_t(first);
+		const size_t end = pos + count;
+		while (pos < end)
+		{
+			const size_t wordIndex = pos >> WordShift;
+			const size_t last = ion::Min(end, (wordIndex + 1) << WordShift);
+			const Word mask = RangeMask(pos & (WordBits - 1), last - pos);
+			Word& word = mLevels[0][wordIndex];
+			ION_ASSERT((word & mask) == 0, "Duplicate free");
+			const bool wasEmpty = word == 0;
+			word |= mask;
+			mNumFree += T(last - pos);
+			if (wasEmpty)
+			{
+				SetBit(wordIndex, 1);
+			}
+			pos = last;
+		}
+	}
+
+	// Removes free ids from the end of the id space. Cost is constant per word of freed ids.
+	void Shrink()
+	{
+		while (mTotalItems > 0)
+		{
+			const size_t last = size_t(mTotalItems) - 1;
+			const size_t wordIndex = last >> WordShift;
+			const size_t bit = last & (WordBits - 1);
+			Word& word = mLevels[0][wordIndex];
+
+			// Count free ids downwards from the last id
+			const Word used = ~word << (WordBits - 1 - bit);
+			const size_t numFree = ion::Min(size_t(ion::CountLeadingZeroes<Word>(used)), bit + 1);
+			if (numFree == 0)
+			{
+				break;
+			}
+			word &= ~RangeMask(bit + 1 - numFree, numFree);
+			if (word == 0)
+			{
+				ClearBit(wordIndex, 1);
+			}
+			mTotalItems -= T(numFree);
+			mNumFree -= T(numFree);
+			if (numFree != bit + 1)
+			{
+				break;
+			}
+		}
+	}
+
+	// Calls callback(T id) for each used id in ascending order
+	template <typename Callback>
+	void ForEachUsed(Callback&& callback) const
+	{
+		const size_t numWords = NumWords(mTotalItems);
+		for (size_t i = 0; i < numWords; ++i)
+		{
+			const T base = T(i << WordShift);
+			ion::ForEachEnabledBit(UsedBits(i), [&](int bit) { callback(T(base + T(bit))); });
+		}
+	}
+
+	// Calls callback(T first, T count) for each range of consecutive used ids in ascending order
+	template <typename Callback>
+	void ForEachUsedRange(Callback&& callback) const
+	{
+		size_t pos = 0;
+		const size_t end = size_t(mTotalItems);
+		while (pos < end)
+		{
+			const size_t first = FindNext(pos, true);
+			if (first == end)
+			{
+				break;
+			}
+			pos = FindNext(first, false);
+			callback(T(first), T(pos - first));
+		}
+	}
+
+	// Number of words in free id bitset. Bit of id is set when id is free.
+	size_t NumFreeBitWords() const { return NumWords(size_t(mTotalItems)); }
+
+	const uint64_t* FreeBitWords() const { return mLevels[0].Data(); }
+
+	// Restores id space of 'totalItems' ids using free id bitset of NumFreeBitWords() words
+	void Restore(T totalItems, const uint64_t* freeBits)
+	{
+		Reset();
+		if (totalItems == 0)
+		{
+			return;
+		}
+		Grow(size_t(totalItems));
+		mTotalItems = totalItems;
+		const size_t numWords = NumWords(size_t(totalItems));
+		std::memcpy(mLevels[0].Data(), freeBits, numWords * sizeof(Word));
+		const size_t tail = size_t(totalItems) & (WordBits - 1);
+		if (tail != 0)
+		{
+			mLevels[0][numWords - 1] &= RangeMask(0, tail);
+		}
+		size_t numFree = 0;
+		for (size_t i = 0; i < numWords; ++i)
+		{
+			numFree += size_t(ion::PopCount(mLevels[0][i]));
+		}
+		mNumFree = T(numFree);
+		for (size_t level = 1; level < mNumLevels; ++level)
+		{
+			for (size_t i = 0; i < mLevels[level].Size(); ++i)
+			{
+				mLevels[level][i] = 0;
+			}
+			for (size_t i = 0; i < mLevels[level - 1].Size(); ++i)
+			{
+				if (mLevels[level - 1][i] != 0)
+				{
+					mLevels[level][i >> WordShift] |= BitOf(i);
+				}
+			}
+		}
+	}
+
+	ion::Vector<T> CreateUsedIdList() const
+	{
+		ion::Vector<T> list;
+		list.Reserve(Size());
+		ForEachUsed([&](T id) { list.Add(id); });
+		return list;
+	}
+
+private:
+	static constexpr Word BitOf(size_t index) { return Word(1) << (index & (WordBits - 1)); }
+
+	static constexpr Word RangeMask(size_t first, size_t count)
+	{
+		return (count == WordBits ? ~Word(0) : ((Word(1) << count) - 1)) << first;
+	}
+
+	static constexpr size_t NumWords(size_t numBits) { return (numBits + WordBits - 1) >> WordShift; }
+
+	// Used bits of level 0 word, bits past the end of id space are excluded
+	Word UsedBits(size_t wordIndex) const
+	{
+		Word used = ~mLevels[0][wordIndex];
+		const size_t end = size_t(mTotalItems) - (wordIndex << WordShift);
+		return end < WordBits ? used & RangeMask(0, end) : used;
+	}
+
+	// Finds next used or free id starting from 'pos'. Returns Max() if not found.
+	size_t FindNext(size_t pos, bool findUsed) const
+	{
+		const size_t end = size_t(mTotalItems);
+		size_t wordIndex = pos >> WordShift;
+		Word word = (findUsed ? UsedBits(wordIndex) : mLevels[0][wordIndex]) & ~RangeMask(0, pos & (WordBits - 1));
+		const size_t numWords = NumWords(end);
+		while (word == 0)
+		{
+			if (++wordIndex == numWords)
+			{
+				return end;
+			}
+			word = findUsed ? UsedBits(wordIndex) : mLevels[0][wordIndex];
+		}
+		return ion::Min((wordIndex << WordShift) + size_t(ion::CountTrailingZeroes<Word>(word)), end);
+	}
+
+	size_t FindLowestFree() const
+	{
+		size_t index = 0;
+		for (size_t level = mNumLevels; level-- > 0;)
+		{
+			const Word word = mLevels[level][index];
+			ION_ASSERT(word != 0, "Invalid free id tracking");
+			index = (index << WordShift) + size_t(ion::CountTrailingZeroes<Word>(word));
+		}
+		return index;
+	}
+
+	// Clears bit and clears upper level bits of words that became empty
+	void ClearBit(size_t index, size_t level = 0)
+	{
+		for (; level < mNumLevels; ++level)
+		{
+			Word& word = mLevels[level][index >> WordShift];
+			word &= ~BitOf(index);
+			if (word != 0)
+			{
+				break;
+			}
+			index >>= WordShift;
+		}
+	}
+
+	// Sets bit and sets upper level bits of words that were empty
+	void SetBit(size_t index, size_t level = 0)
+	{
+		for (; level < mNumLevels; ++level)
+		{
+			Word& word = mLevels[level][index >> WordShift];
+			const bool wasEmpty = word == 0;
+			word |= BitOf(index);
+			if (!wasEmpty)
+			{
+				break;
+			}
+			index >>= WordShift;
+		}
+	}
+
+	// Makes room for 'numIds' ids. New ids are not free, thus existing summary bits stay valid.
+	void Grow(size_t numIds)
+	{
+		size_t numWords = NumWords(numIds);
+		if (mNumLevels > 0 && numWords <= mLevels[0].Size())
+		{
+			return;
+		}
+		numWords = ion::Max(numWords, size_t(mLevels[0].Size()) * 2);
+		size_t level = 0;
+		for (;;)
+		{
+			ION_ASSERT(level < MaxLevels, "Out of id space");
+			if (level < mNumLevels)
+			{
+				mLevels[level].Resize(numWords);
+			}
+			else
+			{
+				// New top level, summarize level below
+				mLevels[level].Clear();
+				mLevels[level].Resize(numWords);
+				if (level > 0)
+				{
+					for (size_t i = 0; i < mLevels[level - 1].Size(); ++i)
+					{
+						if (mLevels[level - 1][i] != 0)
+						{
+							mLevels[level][i >> WordShift] |= BitOf(i);
+						}
+					}
+				}
+				mNumLevels = level + 1;
+			}
+			if (numWords == 1)
+			{
+				break;
+			}
+			numWords = NumWords(numWords);
+			level++;
+		}
+	}
+
+	ion::Vector<Word, WordAllocator> mLevels[MaxLevels];
+	size_t mNumLevels = 0;
+	T mTotalItems = 0;
+	T mNumFree = 0;
+};
+
+}  // namespace ion
@@ -17,6 +17,7 @@
 
 #include <ion/Base.h>
 #include <ion/util/BitsCImpl.h>
+#include <ion/util/SafeRangeCast.h>
 #if __cplusplus >= 202002L && ION_PLATFORM_MICROSOFT
 	#include <bit>
 #endif
@@ -96,6 +97,24 @@ template <>
 	return ion_CountLeadingZeroes64(ion::SafeRangeCast<unsigned long long>(v));
 }
 
+// Number of set bits
+template <typename T>
+[[nodiscard]] inline int PopCount(T v)
+{
+	static_assert(std::is_unsigned_v<T>, "Unsigned type expected");
+#if ION_COMPILER_MSVC
+	#ifdef _WIN64
+	return int(__popcnt64(uint64_t(v)));
+	#else
+	return int(__popcnt(uint32_t(uint64_t(v) & 0xffffffff)) + __popcnt(uint32_t(uint64_t(v) >> 32)));
+	#endif
+#elif ION_HAS_BUILTIN(__builtin_popcountll)
+	return __builtin_popcountll(uint64_t(v));
+#else
+	static_assert(false, "Not implemented");
+#endif
+}
+
 template <class To, class From,
 		  std::enable_if_t<std::conjunction_v<std::bool_constant<sizeof(To) == sizeof(From)>, std::is_trivially_copyable<To>,
 											  std::is_trivially_copyable<From>>,
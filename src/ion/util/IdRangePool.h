@@ -135,6 +135,29 @@ public:
 
 	T Max() const { return mTotalItems; }
 
+	// Calls callback(T index, T count) for each free range in no specific order
+	template <typename Callback>
+	void ForEachFreeRange(Callback&& callback) const
+	{
+		ion::PriorityQueue<Group> largeRanges(mFreeItems);
+		while (!largeRanges.IsEmpty())
+		{
+			callback(largeRanges.Top().mIndex, largeRanges.Top().mCount);
+			largeRanges.Pop();
+		}
+		for (auto iter = mGroupStartIndices.Begin(); iter != mGroupStartIndices.End(); ++iter)
+		{
+			callback(iter->first, iter->second);
+		}
+	}
+
+	// Clears free ranges and sets all 'totalItems' items reserved. Use Free() to restore free ranges.
+	void Reset(T totalItems)
+	{
+		*this = IdRangePool();
+		mTotalItems = totalItems;
+	}
+
 private:
 	void AddFreeRange(T index, T count)
 	{
@@ -16,10 +16,15 @@
 
 #include <ion/hw/CPU.inl>
 #include <ion/tracing/Log.h>
+#include <ion/util/Math.h>
 #include <ion/util/OsInfo.h>
 #if !ION_PLATFORM_MICROSOFT
 	#include <sys/sysinfo.h>
 	#include <unistd.h>
+	#if ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+		#include <sys/syscall.h>
+		#include <cstdio>
+	#endif
 #else
 	#include "psapi.h"
 #endif
@@ -33,11 +38,53 @@ struct OsSystemInfo
 {
 	size_t mMemoryPageSize = 0;
 	unsigned mHWConcurrency = 0;
+	UInt mNumaNodeCount = 1;
 	bool mReady = false;
 };
 namespace
 {
 
+UInt ReadNumaNodeCount()
+{
+	UInt count = 1;
+#if ION_PLATFORM_MICROSOFT
+	ULONG highestNode = 0;
+	if (GetNumaHighestNodeNumber(&highestNode))
+	{
+		count = UInt(highestNode) + 1;
+	}
+#elif ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID
+	// Online nodes are listed as ranges, e.g. "0-1" or "0,2-3"
+	if (FILE* file = fopen("/sys/devices/system/node/online", "r"))
+	{
+		char buffer[256];
+		size_t len = fread(buffer, 1, sizeof(buffer) - 1, file);
+		fclose(file);
+		buffer[len] = 0;
+		UInt value = 0;
+		bool hasValue = false;
+		for (size_t i = 0; i <= len; ++i)
+		{
+			if (buffer[i] >= '0' && buffer[i] <= '9')
+			{
+				value = value * 10 + UInt(buffer[i] - '0');
+				hasValue = true;
+			}
+			else
+			{
+				if (hasValue)
+				{
+					count = ion::Max(count, value + 1);
+				}
+				value = 0;
+				hasValue = false;
+			}
+		}
+	}
+#endif
+	return count;
+}
+
 const OsSystemInfo& GetSystemInfo()
 {
 	static OsSystemInfo systemInfo;
@@ -75,6 +122,7 @@ const OsSystemInfo& GetSystemInfo()
 		ION_CHECK(memoryPageSize != 0, "Cannot read memory page size");
 		systemInfo.mHWConcurrency = hwConcurrency != 0 ? hwConcurrency : 1;
 		systemInfo.mMemoryPageSize = memoryPageSize != 0 ? memoryPageSize : 4096;
+		systemInfo.mNumaNodeCount = ReadNumaNodeCount();
 		systemInfo.mReady = true;
 	}
 	return systemInfo;
@@ -85,6 +133,29 @@ unsigned OsHardwareConcurrency() { return GetSystemInfo().mHWConcurrency; }
 
 size_t OsMemoryPageSize() { return GetSystemInfo().mMemoryPageSize; }
 
+UInt OsNumaNodeCount() { return GetSystemInfo().mNumaNodeCount; }
+
+UInt OsNumaNode()
+{
+#if ION_PLATFORM_MICROSOFT
+	PROCESSOR_NUMBER processor;
+	GetCurrentProcessorNumberEx(&processor);
+	USHORT node = 0;
+	if (GetNumaProcessorNodeEx(&processor, &node))
+	{
+		return UInt(node);
+	}
+#elif (ION_PLATFORM_LINUX || ION_PLATFORM_ANDROID) && defined(SYS_getcpu)
+	unsigned cpu = 0;
+	unsigned node = 0;
+	if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+	{
+		return UInt(node);
+	}
+#endif
+	return 0;
+}
+
 #if ION_CONFIG_DEV_TOOLS && ION_PLATFORM_MICROSOFT && 0	 // Requires PSAPI dll
 void OsMemoryInfo()
 {
@@ -31,4 +31,10 @@ void OsMemoryInfo();
 
 UInt OsProcessorNumber();
 
+// Returns number of NUMA memory nodes. Returns 1 if NUMA information is not available.
+UInt OsNumaNodeCount();
+
+// Returns NUMA memory node of the processor running calling thread.
+UInt OsNumaNode();
+
 }  // namespace ion